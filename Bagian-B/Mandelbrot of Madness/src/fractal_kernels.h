@@ -0,0 +1,267 @@
+#ifndef FRACTAL_KERNELS_H
+#define FRACTAL_KERNELS_H
+
+// Escape-time kernels shared by the CPU generators, the GUI previews and the CUDA kernels.
+// Each formula is a template, so every variant gets its own fully inlined inner loop with
+// no per-iteration branching on the fractal type.
+
+#include <cmath>
+
+#ifdef __CUDACC__
+#define FRACTAL_HD __host__ __device__ __forceinline__
+#else
+#define FRACTAL_HD inline
+#endif
+
+// Distance estimation escapes at |z| = 1000 instead of 2: the estimate is only accurate once
+// |z| is large, and the few extra iterations are cheap
+#define DISTANCE_BAILOUT 1e6
+
+// Double-double: an unevaluated sum hi + lo of two doubles, about 106 bits of mantissa. Slow,
+// only for views whose pixel spacing is below what a double can resolve.
+struct DoubleDouble {
+    double hi, lo;
+    FRACTAL_HD DoubleDouble() : hi(0.0), lo(0.0) {}
+    FRACTAL_HD DoubleDouble(double value) : hi(value), lo(0.0) {}
+    FRACTAL_HD DoubleDouble(double high, double low) : hi(high), lo(low) {}
+};
+
+// a + b = s + e exactly
+FRACTAL_HD void dd_two_sum(double a, double b, double& s, double& e) {
+    s = a + b;
+    double v = s - a;
+    e = (a - (s - v)) + (b - v);
+}
+
+// a * b = p + e exactly: one fma on the GPU, Dekker's split on the host (no fma required)
+FRACTAL_HD void dd_two_prod(double a, double b, double& p, double& e) {
+    p = a * b;
+#ifdef __CUDA_ARCH__
+    e = fma(a, b, -p);
+#else
+    const double split = 134217729.0;    // 2^27 + 1
+    double t = split * a, a_hi = t - (t - a), a_lo = a - a_hi;
+    t = split * b;
+    double b_hi = t - (t - b), b_lo = b - b_hi;
+    e = ((a_hi * b_hi - p) + a_hi * b_lo + a_lo * b_hi) + a_lo * b_lo;
+#endif
+}
+
+FRACTAL_HD DoubleDouble dd_normalize(double s, double e) {
+    double hi = s + e;
+    return DoubleDouble(hi, e - (hi - s));
+}
+
+FRACTAL_HD DoubleDouble operator+(DoubleDouble a, DoubleDouble b) {
+    double s, e;
+    dd_two_sum(a.hi, b.hi, s, e);
+    return dd_normalize(s, e + a.lo + b.lo);
+}
+
+FRACTAL_HD DoubleDouble operator-(DoubleDouble a) { return DoubleDouble(-a.hi, -a.lo); }
+FRACTAL_HD DoubleDouble operator-(DoubleDouble a, DoubleDouble b) { return a + (-b); }
+
+FRACTAL_HD DoubleDouble operator*(DoubleDouble a, DoubleDouble b) {
+    double p, e;
+    dd_two_prod(a.hi, b.hi, p, e);
+    return dd_normalize(p, e + (a.hi * b.lo + a.lo * b.hi));
+}
+
+// The sign and the magnitude live in hi
+FRACTAL_HD bool operator<(DoubleDouble a, double b) { return a.hi < b || (a.hi == b && a.lo < 0.0); }
+FRACTAL_HD double to_double(DoubleDouble a) { return a.hi; }
+FRACTAL_HD double to_double(double a) { return a; }
+FRACTAL_HD double to_double(float a) { return a; }
+
+// |z|^2 for the escape test, which needs no extra precision
+template <class T>
+FRACTAL_HD T escape_norm(T z_real, T z_imag) { return z_real * z_real + z_imag * z_imag; }
+FRACTAL_HD double escape_norm(DoubleDouble z_real, DoubleDouble z_imag) { return z_real.hi * z_real.hi + z_imag.hi * z_imag.hi; }
+
+// origin + offset as a T. Rounded for float and double; exact for double-double, where the
+// offset of a pixel inside a deep view is below the rounding step of the origin.
+template <class T>
+FRACTAL_HD T plane_point(double origin, double offset) { return T(origin + offset); }
+template <>
+FRACTAL_HD DoubleDouble plane_point<DoubleDouble>(double origin, double offset) {
+    double s, e;
+    dd_two_sum(origin, offset, s, e);
+    return DoubleDouble(s, e);
+}
+
+// Scalar type of the escape loops
+enum class Precision {
+    AUTO = 0,          // resolved per view by MandelbrotGenerator
+    FLOAT,
+    DOUBLE,
+    DOUBLE_DOUBLE,
+    PRECISION_COUNT
+};
+
+enum class FractalType {
+    MANDELBROT = 0,    // z^2 + c
+    MULTIBROT_3,       // z^3 + c
+    MULTIBROT_4,       // z^4 + c
+    BURNING_SHIP,      // (|Re z| + i|Im z|)^2 + c
+    TRICORN,           // conj(z)^2 + c
+    FRACTAL_COUNT
+};
+
+// z -> fold(z)^Power + c. AbsFold takes |Re z| and |Im z| first, Conjugate takes conj(z).
+// step() works on any scalar: float, double or DoubleDouble.
+template <int Power, bool AbsFold, bool Conjugate>
+struct Formula {
+    static_assert(Power >= 2, "escape radius 2 needs a power of at least 2");
+
+    // c and conj(c) escape alike unless the fold breaks the real-coefficient form
+    static constexpr bool conjugate_symmetric = !AbsFold;
+    // z and -z reach the same orbit: even powers, or a fold that discards the signs
+    static constexpr bool point_symmetric = AbsFold || (Power % 2 == 0);
+
+    template <class T>
+    static FRACTAL_HD void step(T& z_real, T& z_imag, T c_real, T c_imag) {
+        T re = z_real, im = z_imag;
+        if constexpr (AbsFold) {
+            re = re < 0.0 ? -re : re;
+            im = im < 0.0 ? -im : im;
+        }
+        if constexpr (Conjugate) {
+            im = -im;
+        }
+
+        T p_real = re, p_imag = im;
+        for (int k = 1; k < Power; k++) {
+            T temp = p_real * re - p_imag * im;
+            p_imag = p_real * im + p_imag * re;
+            p_real = temp;
+        }
+
+        z_real = p_real + c_real;
+        z_imag = p_imag + c_imag;
+    }
+
+    // dz -> Power * fold(z)^(Power - 1) * fold(dz) + add, with z taken before step(). add is 1 for
+    // dz/dc (Mandelbrot) and 0 for dz/dz0 (Julia). The folds are not complex-differentiable, for
+    // Burning Ship and Tricorn this is the usual approximation that applies them to dz as well.
+    static FRACTAL_HD void derivative_step(double z_real, double z_imag, double& d_real, double& d_imag, double add) {
+        double re = z_real, im = z_imag, d_re = d_real, d_im = d_imag;
+        if constexpr (AbsFold) {
+            if (re < 0.0) { re = -re; d_re = -d_re; }
+            if (im < 0.0) { im = -im; d_im = -d_im; }
+        }
+        if constexpr (Conjugate) {
+            im = -im;
+            d_im = -d_im;
+        }
+
+        double p_real = 1.0, p_imag = 0.0;
+        for (int k = 1; k < Power; k++) {
+            double temp = p_real * re - p_imag * im;
+            p_imag = p_real * im + p_imag * re;
+            p_real = temp;
+        }
+
+        d_real = Power * (p_real * d_re - p_imag * d_im) + add;
+        d_imag = Power * (p_real * d_im + p_imag * d_re);
+    }
+};
+
+typedef Formula<2, false, false> MandelbrotFormula;
+typedef Formula<3, false, false> Multibrot3Formula;
+typedef Formula<4, false, false> Multibrot4Formula;
+typedef Formula<2, true, false> BurningShipFormula;
+typedef Formula<2, false, true> TricornFormula;
+
+// Iterations until |z| > 2, capped at max_iterations. Mandelbrot: z0 = 0 and c = point.
+// Julia: z0 = point and c = the Julia constant. T is the precision of the orbit.
+template <class F, bool Julia, class T = double>
+FRACTAL_HD int escape_iterations(T point_real, T point_imag, T c_real, T c_imag, int max_iterations) {
+    T z_real = 0.0, z_imag = 0.0;
+    if constexpr (Julia) {
+        z_real = point_real;
+        z_imag = point_imag;
+    } else {
+        c_real = point_real;
+        c_imag = point_imag;
+    }
+
+    int iterations = 0;
+    while (escape_norm(z_real, z_imag) <= 4 && iterations < max_iterations) {
+        F::step(z_real, z_imag, c_real, c_imag);
+        iterations++;
+    }
+
+    return iterations;
+}
+
+// escape_iterations plus the exterior distance estimate 0.5 * |z| * ln|z| / |dz| (in plane units),
+// 0 for points that never escape. Iteration counts run a few higher than escape_iterations'.
+// The orbit runs in T, the derivative in double (it only needs relative accuracy).
+template <class F, bool Julia, class T = double>
+FRACTAL_HD int escape_distance(T point_real, T point_imag, T c_real, T c_imag, int max_iterations, double& distance) {
+    T z_real = 0.0, z_imag = 0.0;
+    double d_real = 0.0, d_imag = 0.0, add = 1.0;
+    if constexpr (Julia) {
+        z_real = point_real;
+        z_imag = point_imag;
+        d_real = 1.0;
+        add = 0.0;
+    } else {
+        c_real = point_real;
+        c_imag = point_imag;
+    }
+
+    int iterations = 0;
+    double norm = to_double(escape_norm(z_real, z_imag));
+    while (norm <= DISTANCE_BAILOUT && iterations < max_iterations) {
+        F::derivative_step(to_double(z_real), to_double(z_imag), d_real, d_imag, add);
+        F::step(z_real, z_imag, c_real, c_imag);
+        norm = to_double(escape_norm(z_real, z_imag));
+        iterations++;
+    }
+
+    distance = 0.0;
+    if (iterations < max_iterations) {
+        double modulus = sqrt(norm);
+        distance = 0.5 * modulus * log(modulus) / sqrt(d_real * d_real + d_imag * d_imag);
+    }
+
+    return iterations;
+}
+
+// Calls fn(F()) with the formula type of a runtime FractalType: the switch happens once per
+// render, never inside the pixel loop
+template <class Fn>
+inline void with_formula(FractalType type, Fn&& fn) {
+    switch (type) {
+        case FractalType::MULTIBROT_3:  fn(Multibrot3Formula()); break;
+        case FractalType::MULTIBROT_4:  fn(Multibrot4Formula()); break;
+        case FractalType::BURNING_SHIP: fn(BurningShipFormula()); break;
+        case FractalType::TRICORN:      fn(TricornFormula()); break;
+        default:                        fn(MandelbrotFormula()); break;
+    }
+}
+
+// Calls fn(T()) with the scalar type of a resolved precision, once per render like with_formula
+template <class Fn>
+inline void with_precision(Precision precision, Fn&& fn) {
+    switch (precision) {
+        case Precision::FLOAT:         fn(float()); break;
+        case Precision::DOUBLE_DOUBLE: fn(DoubleDouble()); break;
+        default:                       fn(double()); break;
+    }
+}
+
+inline bool has_conjugate_symmetry(FractalType type) {
+    bool symmetric = false;
+    with_formula(type, [&](auto formula) { symmetric = decltype(formula)::conjugate_symmetric; });
+    return symmetric;
+}
+
+inline bool has_point_symmetry(FractalType type) {
+    bool symmetric = false;
+    with_formula(type, [&](auto formula) { symmetric = decltype(formula)::point_symmetric; });
+    return symmetric;
+}
+
+#endif // FRACTAL_KERNELS_H
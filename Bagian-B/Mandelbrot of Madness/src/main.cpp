@@ -5,6 +5,7 @@
 #include <chrono>
 #include <ctime>
 #include <sstream>
+#include <algorithm>
 
 std::string get_timestamp() {
     auto now = std::chrono::system_clock::now();
@@ -22,6 +23,42 @@ int main(int argc, char* argv[]) {
     int width = 1920;
     int height = 1080;
     int max_iterations = 1000;
+    FractalType fractal = FractalType::MANDELBROT;
+    bool distance_shading = false;
+    int aa_samples = 0;
+    Precision precision = Precision::AUTO;
+    std::vector<bool> backends;
+    parse_backends("serial,parallel,cuda", backends);
+    
+    if (argc >= 5 && !parse_fractal(argv[4], fractal)) {
+        std::cerr << "Error: Unknown fractal " << argv[4]
+                  << " (mandelbrot, multibrot3, multibrot4, burningship, tricorn)" << std::endl;
+        return 1;
+    }
+    if (argc >= 6) {
+        std::string shading = argv[5];
+        if (shading != "iterations" && shading != "distance") {
+            std::cerr << "Error: Unknown shading " << shading << " (iterations, distance)" << std::endl;
+            return 1;
+        }
+        distance_shading = shading == "distance";
+    }
+    if (argc >= 7) {
+        aa_samples = std::atoi(argv[6]);
+        if (aa_samples < 0 || aa_samples > 64) {
+            std::cerr << "Error: AA samples must be 0-64" << std::endl;
+            return 1;
+        }
+    }
+    
+    if (argc >= 8 && (!parse_backends(argv[7], backends) || std::find(backends.begin(), backends.end(), true) == backends.end())) {
+        std::cerr << "Error: Unknown backend list " << argv[7] << " (comma-separated: serial, parallel, cuda)" << std::endl;
+        return 1;
+    }
+    if (argc >= 9 && !parse_precision(argv[8], precision)) {
+        std::cerr << "Error: Unknown precision " << argv[8] << " (auto, float, double, doubledouble)" << std::endl;
+        return 1;
+    }
     
     if (argc >= 4) {
         width = std::atoi(argv[1]);
@@ -31,9 +68,16 @@ int main(int argc, char* argv[]) {
         width = std::atoi(argv[1]);
         height = std::atoi(argv[2]);
     } else if (argc >= 2) {
-        std::cout << "Usage: " << argv[0] << " [width] [height] [iterations]" << std::endl;
+        std::cout << "Usage: " << argv[0] << " [width] [height] [iterations] [fractal] [shading] [aa_samples] [backends] [precision]" << std::endl;
         std::cout << "Max resolution: " << MAX_CLI_RESOLUTION << "x" << MAX_CLI_RESOLUTION << std::endl;
         std::cout << "Max iterations: " << MAX_CLI_ITERATIONS << std::endl;
+        std::cout << "Fractals: mandelbrot (default), multibrot3, multibrot4, burningship, tricorn" << std::endl;
+        std::cout << "Shading: iterations (default), distance (CPU only, sharp boundaries at low iterations)" << std::endl;
+        std::cout << "AA samples: 0 (default, off) or up to 64 per edge pixel, CPU only" << std::endl;
+        std::cout << "Backends: serial,parallel,cuda (default all); the serial baseline runs last and is" << std::endl;
+        std::cout << "          reused from ../output/baseline_cache.txt when the scene was measured before" << std::endl;
+        std::cout << "Precision: auto (default: float on CUDA, double on the CPU, double-double once the pixel" << std::endl;
+        std::cout << "           spacing nears double's rounding step), float, double or doubledouble" << std::endl;
         std::cout << "Example: " << argv[0] << " 1920 1080 1000" << std::endl;
         return 1;
     }
@@ -54,118 +98,173 @@ int main(int argc, char* argv[]) {
     std::cout << "=== Mandelbrot CLI Generator ===" << std::endl;
     std::cout << "Resolution: " << width << "x" << height << std::endl;
     std::cout << "Max iterations: " << max_iterations << std::endl;
+    std::cout << "Fractal: " << fractal_name(fractal) << std::endl;
+    std::cout << "Shading: " << (distance_shading ? "distance" : "iterations") << std::endl;
+    std::cout << "AA samples: " << aa_samples << std::endl;
+    std::cout << "Backends:";
+    for (int b = 0; b < (int)Backend::BACKEND_COUNT; b++) {
+        if (backends[b]) std::cout << " " << backend_name((Backend)b);
+    }
+    std::cout << std::endl;
+    std::cout << "Precision: " << precision_name(precision) << std::endl;
     std::cout << "Total pixels: " << width * height << std::endl;
     std::cout << std::endl;
     
     print_system_info();
     
     MandelbrotGenerator generator(width, height, max_iterations);
+    generator.set_fractal(fractal);
+    generator.set_distance_estimation(distance_shading);
+    generator.set_antialiasing(aa_samples);
+    generator.set_precision(precision);
     std::vector<Color> image(width * height);
 
+    // 0 = not run
     double serial_time = 0.0;
     double parallel_time = 0.0;
     double cuda_time = 0.0;
+    
+    // A baseline measured on an earlier run of this scene is reused even when serial is not selected
+    BaselineCache baseline_cache("../output/baseline_cache.txt");
+    std::string scene = generator.scene_key();
+    bool serial_cached = baseline_cache.lookup(scene, Backend::SERIAL, serial_time);
+
+    if (backends[(int)Backend::PARALLEL]) {
+        std::cout << "=== Parallel CPU Implementation ===" << std::endl;
+        std::cout << "Running parallel CPU implementation (" << precision_name(generator.render_precision(false))
+                  << ")..." << std::endl;
+        parallel_time = benchmark_function([&]() {
+            generator.generate_parallel_threads(image);
+        });
+        std::cout << "Parallel CPU time: " << std::fixed << std::setprecision(3) << parallel_time << " seconds" << std::endl;
 
-    std::cout << "=== Serial CPU Implementation ===" << std::endl;
-    std::cout << "Running serial CPU implementation..." << std::endl;
-    serial_time = benchmark_function([&]() {
-        generator.generate_serial(image);
-    });
-    std::cout << "Serial time: " << std::fixed << std::setprecision(3) << serial_time << " seconds" << std::endl;
+        std::string parallel_filename = "../output/cli_mandelbrot_parallel_" + 
+                                       std::to_string(width) + "x" + std::to_string(height) + 
+                                       "_iter" + std::to_string(max_iterations) + "_" + 
+                                       get_timestamp() + ".bmp";
+        generator.save_bmp(image, parallel_filename);
+        std::cout << "Saved: " << parallel_filename << std::endl;
 
-    std::string serial_filename = "../output/cli_mandelbrot_serial_" + 
-                                 std::to_string(width) + "x" + std::to_string(height) + 
-                                 "_iter" + std::to_string(max_iterations) + "_" + 
-                                 get_timestamp() + ".bmp";
-    generator.save_bmp(image, serial_filename);
-    std::cout << "Saved: " << serial_filename << std::endl;
-    std::cout << std::endl;
-    
-    std::cout << "=== Parallel CPU Implementation ===" << std::endl;
-    std::cout << "Running parallel CPU implementation..." << std::endl;
-    parallel_time = benchmark_function([&]() {
+        // One extra untimed render for the counters: instrumentation stays out of the timing
+        generator.set_instrumentation(true);
         generator.generate_parallel_threads(image);
-    });
-    std::cout << "Parallel CPU time: " << std::fixed << std::setprecision(3) << parallel_time << " seconds" << std::endl;
-    std::cout << "CPU speedup: " << std::fixed << std::setprecision(2) << serial_time / parallel_time << "x" << std::endl;
+        generator.set_instrumentation(false);
+        print_render_stats(generator.get_stats());
 
-    std::string parallel_filename = "../output/cli_mandelbrot_parallel_" + 
+        std::string cost_filename = "../output/cli_mandelbrot_cost_" + 
                                    std::to_string(width) + "x" + std::to_string(height) + 
                                    "_iter" + std::to_string(max_iterations) + "_" + 
                                    get_timestamp() + ".bmp";
-    generator.save_bmp(image, parallel_filename);
-    std::cout << "Saved: " << parallel_filename << std::endl;
-    std::cout << std::endl;
+        generator.save_cost_heatmap(cost_filename);
+        std::cout << "Saved: " << cost_filename << std::endl;
+        std::cout << std::endl;
+    }
 
-    #ifdef USE_CUDA
-    std::cout << "=== CUDA GPU Implementation ===" << std::endl;
-    std::cout << "Initializing CUDA..." << std::endl;
-    if (!generator.init_cuda()) {
-        std::cout << "CUDA initialization failed" << std::endl;
-    } else {
-        std::cout << "Running CUDA GPU implementation..." << std::endl;
-        cuda_time = benchmark_function([&]() {
-            generator.generate_cuda(image);
-        });
-        std::cout << "CUDA GPU time: " << std::fixed << std::setprecision(3) << cuda_time << " seconds" << std::endl;
-        std::cout << "GPU speedup vs Serial: " << std::fixed << std::setprecision(2) << serial_time / cuda_time << "x" << std::endl;
-        std::cout << "GPU speedup vs Parallel CPU: " << std::fixed << std::setprecision(2) << parallel_time / cuda_time << "x" << std::endl;
-        
-        std::string cuda_filename = "../output/cli_mandelbrot_cuda_" + 
-                                   std::to_string(width) + "x" + std::to_string(height) + 
-                                   "_iter" + std::to_string(max_iterations) + "_" + 
-                                   get_timestamp() + ".bmp";
-        generator.save_bmp(image, cuda_filename);
-        std::cout << "Saved: " << cuda_filename << std::endl;
-        
+    if (backends[(int)Backend::CUDA]) {
+        std::cout << "=== CUDA GPU Implementation ===" << std::endl;
+        #ifdef USE_CUDA
+        std::cout << "Initializing CUDA..." << std::endl;
+        if (!generator.init_cuda()) {
+            std::cout << "CUDA initialization failed" << std::endl;
+        } else {
+            std::cout << "Running CUDA GPU implementation (" << precision_name(generator.render_precision(true))
+                      << ")..." << std::endl;
+            cuda_time = benchmark_function([&]() {
+                generator.generate_cuda(image);
+            });
+            std::cout << "CUDA GPU time: " << std::fixed << std::setprecision(3) << cuda_time << " seconds" << std::endl;
+            
+            std::string cuda_filename = "../output/cli_mandelbrot_cuda_" + 
+                                       std::to_string(width) + "x" + std::to_string(height) + 
+                                       "_iter" + std::to_string(max_iterations) + "_" + 
+                                       get_timestamp() + ".bmp";
+            generator.save_bmp(image, cuda_filename);
+            std::cout << "Saved: " << cuda_filename << std::endl;
+            generator.cleanup_cuda();
+        }
+        #else
+        std::cout << "CUDA not available (compile with USE_CUDA flag)" << std::endl;
+        #endif
         std::cout << std::endl;
-        std::cout << "=== Performance Summary ===" << std::endl;
-        std::cout << "┌─────────────────────┬─────────────┬─────────────┬─────────────────┐" << std::endl;
-        std::cout << "│ Implementation      │ Time (s)    │ Speedup     │ Throughput      │" << std::endl;
-        std::cout << "├─────────────────────┼─────────────┼─────────────┼─────────────────┤" << std::endl;
-        
-        double pixels_per_second_serial = (width * height) / serial_time;
-        std::cout << "│ Serial CPU          │ " << std::setw(11) << std::fixed << std::setprecision(3) << serial_time 
-                  << " │ " << std::setw(11) << "1.00x" << " │ " << std::setw(11) << std::scientific << std::setprecision(2) 
-                  << pixels_per_second_serial << " px/s │" << std::endl;
-        
-        double pixels_per_second_parallel = (width * height) / parallel_time;
-        std::cout << "│ Parallel CPU        │ " << std::setw(11) << std::fixed << std::setprecision(3) << parallel_time 
-                  << " │ " << std::setw(11) << std::fixed << std::setprecision(2) << serial_time / parallel_time << "x" 
-                  << " │ " << std::setw(11) << std::scientific << std::setprecision(2) << pixels_per_second_parallel << " px/s │" << std::endl;
-        
-        double pixels_per_second_cuda = (width * height) / cuda_time;
-        std::cout << "│ CUDA GPU            │ " << std::setw(11) << std::fixed << std::setprecision(3) << cuda_time 
-                  << " │ " << std::setw(11) << std::fixed << std::setprecision(2) << serial_time / cuda_time << "x" 
-                  << " │ " << std::setw(11) << std::scientific << std::setprecision(2) << pixels_per_second_cuda << " px/s │" << std::endl;
-        
-        std::cout << "└─────────────────────┴─────────────┴─────────────┴─────────────────┘" << std::endl;
+    }
+
+    // The slow baseline goes last, and only when this scene has not been measured before
+    if (backends[(int)Backend::SERIAL]) {
+        std::cout << "=== Serial CPU Implementation ===" << std::endl;
+        if (serial_cached) {
+            std::cout << "Serial time: " << std::fixed << std::setprecision(3) << serial_time
+                      << " seconds (cached baseline, not re-run)" << std::endl;
+        } else {
+            std::cout << "Running serial CPU implementation (" << precision_name(generator.render_precision(false))
+                      << ")..." << std::endl;
+            serial_time = benchmark_function([&]() {
+                generator.generate_serial(image);
+            });
+            std::cout << "Serial time: " << std::fixed << std::setprecision(3) << serial_time << " seconds" << std::endl;
+            baseline_cache.store(scene, Backend::SERIAL, serial_time);
+
+            std::string serial_filename = "../output/cli_mandelbrot_serial_" + 
+                                         std::to_string(width) + "x" + std::to_string(height) + 
+                                         "_iter" + std::to_string(max_iterations) + "_" + 
+                                         get_timestamp() + ".bmp";
+            generator.save_bmp(image, serial_filename);
+            std::cout << "Saved: " << serial_filename << std::endl;
+        }
         std::cout << std::endl;
+    }
+
+    std::cout << "=== Performance Summary ===" << std::endl;
+    std::cout << "┌─────────────────────┬─────────────┬─────────────┬─────────────────┐" << std::endl;
+    std::cout << "│ Implementation      │ Time (s)    │ Speedup     │ Throughput      │" << std::endl;
+    std::cout << "├─────────────────────┼─────────────┼─────────────┼─────────────────┤" << std::endl;
+    
+    const char* labels[] = { "Serial CPU          ", "Parallel CPU        ", "CUDA GPU            " };
+    double times[] = { serial_time, parallel_time, cuda_time };
+    for (int b = 0; b < (int)Backend::BACKEND_COUNT; b++) {
+        if (times[b] <= 0.0) continue;
         
+        std::stringstream speedup;
+        if (serial_time > 0.0) {
+            speedup << std::fixed << std::setprecision(2) << serial_time / times[b] << "x";
+        } else {
+            speedup << "-";
+        }
+        
+        double pixels_per_second = (width * height) / times[b];
+        std::cout << "│ " << labels[b] << "│ " << std::setw(11) << std::fixed << std::setprecision(3) << times[b] 
+                  << " │ " << std::setw(11) << speedup.str() << " │ " << std::setw(11) << std::scientific << std::setprecision(2) 
+                  << pixels_per_second << " px/s │" << std::endl;
+    }
+    
+    std::cout << "└─────────────────────┴─────────────┴─────────────┴─────────────────┘" << std::endl;
+    if (serial_cached) {
+        std::cout << "(serial baseline from the cache)" << std::endl;
+    }
+    std::cout << std::endl;
+    
+    if (serial_time > 0.0 && (parallel_time > 0.0 || cuda_time > 0.0)) {
         std::cout << "=== Analysis ===" << std::endl;
-        std::cout << "Parallel efficiency: " << std::fixed << std::setprecision(1) 
-                  << (serial_time / parallel_time) / std::thread::hardware_concurrency() * 100 << "%" << std::endl;
-        std::cout << "GPU acceleration factor: " << std::fixed << std::setprecision(1) 
-                  << serial_time / cuda_time << "x faster than serial" << std::endl;
-        std::cout << "GPU vs CPU parallel: " << std::fixed << std::setprecision(1) 
-                  << parallel_time / cuda_time << "x faster than parallel CPU" << std::endl;
-
-        generator.cleanup_cuda();
+        if (parallel_time > 0.0) {
+            std::cout << "Parallel efficiency: " << std::fixed << std::setprecision(1) 
+                      << (serial_time / parallel_time) / generator.thread_count() * 100 << "%" << std::endl;
+        }
+        if (cuda_time > 0.0) {
+            std::cout << "GPU acceleration factor: " << std::fixed << std::setprecision(1) 
+                      << serial_time / cuda_time << "x faster than serial" << std::endl;
+        }
+        if (parallel_time > 0.0 && cuda_time > 0.0) {
+            std::cout << "GPU vs CPU parallel: " << std::fixed << std::setprecision(1) 
+                      << parallel_time / cuda_time << "x faster than parallel CPU" << std::endl;
+        }
     }
-    #else
-    std::cout << "=== CUDA GPU Implementation ===" << std::endl;
-    std::cout << "CUDA not available (compile with USE_CUDA flag)" << std::endl;
-    #endif
     
     std::cout << std::endl;
     std::cout << "=== CLI Generation Complete ===" << std::endl;
     std::cout << "All images saved to ../output/ with cli_mandelbrot_* prefix" << std::endl;
     std::cout << "Generated images:" << std::endl;
-    std::cout << "  - Serial CPU result" << std::endl;
-    std::cout << "  - Parallel CPU result" << std::endl;
-    #ifdef USE_CUDA
-    std::cout << "  - CUDA GPU result" << std::endl;
-    #endif
+    if (serial_time > 0.0 && !serial_cached) std::cout << "  - Serial CPU result" << std::endl;
+    if (parallel_time > 0.0) std::cout << "  - Parallel CPU result" << std::endl;
+    if (cuda_time > 0.0) std::cout << "  - CUDA GPU result" << std::endl;
     
     return 0;
 }
\ No newline at end of file
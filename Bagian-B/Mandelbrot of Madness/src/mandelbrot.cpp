@@ -4,6 +4,19 @@
 #include <chrono>
 #include <thread>
 #include <cmath>
+#include <algorithm>
+#include <atomic>
+#include <iomanip>
+#include <sstream>
+#include <cfloat>
+
+// How far (in rows) the mirror of a row may sit from a pixel row and still be reused
+static const double SYMMETRY_TOLERANCE = 1e-6;
+// Distance shading saturates this many pixels away from the boundary
+static const double DISTANCE_SHADE_PIXELS = 4.0;
+// A precision resolves a view when its rounding step at the view's largest coordinate is this
+// many times finer than a pixel, so rounding along an orbit stays inside the pixel's footprint
+static const double PRECISION_MARGIN = 256.0;
 
 #ifdef USE_CUDA
 #include <cuda_runtime.h>
@@ -12,16 +25,20 @@ static bool cuda_initialized = false;
 static int cuda_device = 0;
 
 extern "C" void launch_mandelbrot_kernel(unsigned char* d_image, int width, int height, int max_iterations,
-                                         double x_min, double x_max, double y_min, double y_max);
+                                         double x_min, double x_max, double y_min, double y_max, int fractal,
+                                         int precision);
 extern "C" void launch_julia_kernel(unsigned char* d_image, int width, int height, int max_iterations,
                                     double x_min, double x_max, double y_min, double y_max,
-                                    double c_real, double c_imag);
+                                    double c_real, double c_imag, int fractal, int precision);
 
 #endif // USE_CUDA
 
 MandelbrotGenerator::MandelbrotGenerator(int w, int h, int max_iter) 
     : width(w), height(h), max_iterations(max_iter),
-      x_min(-2.5), x_max(1.5), y_min(-2.0), y_max(2.0) {}
+      x_min(-2.5), x_max(1.5), y_min(-2.0), y_max(2.0), use_symmetry(true), fractal(FractalType::MANDELBROT), use_distance(false),
+      aa_grid(0), aa_threshold(0), refined_pixels(0), num_threads(0),
+      tile_size(32), use_stats(false), schedule(Schedule::PREDICTED),
+      precision(Precision::AUTO), cancel_flag(nullptr) {}
 
 void MandelbrotGenerator::set_bounds(double xmin, double xmax, double ymin, double ymax) {
     x_min = xmin;
@@ -30,26 +47,74 @@ void MandelbrotGenerator::set_bounds(double xmin, double xmax, double ymin, doub
     y_max = ymax;
 }
 
-int MandelbrotGenerator::mandelbrot_iterations(std::complex<double> c) {
-    std::complex<double> z = 0;
-    int iterations = 0;
+// The Mandelbrot set is symmetric about the real axis: conj(c) escapes exactly like c. When the
+// view straddles the axis, row y holds the conjugates of row axis - y. Returns -1 otherwise.
+int MandelbrotGenerator::conjugate_axis() const {
+    if (!use_symmetry || !has_conjugate_symmetry(fractal)) return -1;
+    if (height < 2 || y_min >= 0.0 || y_max <= 0.0) return -1;
+    
+    double axis = -2.0 * y_min * (height - 1) / (y_max - y_min);
+    double rounded = std::round(axis);
+    if (std::abs(axis - rounded) > SYMMETRY_TOLERANCE) return -1;
+    
+    return (int)rounded;
+}
+
+// z and -z escape alike for the even formulas, and the Julia window is centered on the origin
+int MandelbrotGenerator::julia_axis() const {
+    if (!use_symmetry || !has_point_symmetry(fractal)) return -1;
+    return height - 1;
+}
+
+// Rows that have to be iterated: everything but the second row of each mirrored pair
+std::vector<int> MandelbrotGenerator::unique_rows(int axis) const {
+    std::vector<int> rows;
+    rows.reserve(height);
     
-    while (std::abs(z) <= 2.0 && iterations < max_iterations) {
-        z = z * z + c;
-        iterations++;
+    for (int y = 0; y < height; y++) {
+        int mirror = axis - y;
+        if (axis < 0 || mirror < 0 || mirror >= y) {
+            rows.push_back(y);
+        }
     }
     
+    return rows;
+}
+
+// Fills the rows unique_rows skipped. rotate also flips them left to right (180 degree symmetry).
+template <class T>
+void MandelbrotGenerator::mirror_rows(std::vector<T>& buffer, int axis, bool rotate) {
+    if (axis < 0) return;
+    
+    for (int y = 0; y < height; y++) {
+        int mirror = axis - y;
+        if (mirror < 0 || mirror >= y) continue;
+        
+        const T* src = &buffer[mirror * width];
+        T* dst = &buffer[y * width];
+        if (rotate) {
+            std::reverse_copy(src, src + width, dst);
+        } else {
+            std::copy(src, src + width, dst);
+        }
+    }
+}
+
+int MandelbrotGenerator::mandelbrot_iterations(std::complex<double> c) {
+    int iterations = 0;
+    with_formula(fractal, [&](auto formula) {
+        using F = decltype(formula);
+        iterations = escape_iterations<F, false>(c.real(), c.imag(), 0.0, 0.0, max_iterations);
+    });
     return iterations;
 }
 
 int MandelbrotGenerator::julia_iterations(std::complex<double> z, std::complex<double> c) {
     int iterations = 0;
-    
-    while (std::abs(z) <= 2.0 && iterations < max_iterations) {
-        z = z * z + c;
-        iterations++;
-    }
-    
+    with_formula(fractal, [&](auto formula) {
+        using F = decltype(formula);
+        iterations = escape_iterations<F, true>(z.real(), z.imag(), c.real(), c.imag(), max_iterations);
+    });
     return iterations;
 }
 
@@ -66,99 +131,449 @@ Color MandelbrotGenerator::iterations_to_color(int iterations) {
     return Color(r, g, b);
 }
 
-void MandelbrotGenerator::generate_serial(std::vector<Color>& image) {
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            double real = x_min + (x_max - x_min) * x / (width - 1);
-            double imag = y_min + (y_max - y_min) * y / (height - 1);
-            
-            std::complex<double> c(real, imag);
-            int iterations = mandelbrot_iterations(c);
-            
-            image[y * width + x] = iterations_to_color(iterations);
-        }
-    }
+int MandelbrotGenerator::thread_count() const {
+    return num_threads > 0 ? num_threads : (int)std::thread::hardware_concurrency();
 }
 
-void MandelbrotGenerator::generate_parallel_threads(std::vector<Color>& image) {
-    const int num_threads = std::thread::hardware_concurrency();
-    std::vector<std::thread> threads;
+void MandelbrotGenerator::set_antialiasing(int samples, int threshold) {
+    aa_grid = (int)std::sqrt((double)std::max(samples, 0));
+    aa_threshold = threshold;
+}
+
+// Black inside, dark on the boundary and its filaments, white from DISTANCE_SHADE_PIXELS out
+Color MandelbrotGenerator::distance_to_color(double distance, double pixel_size) {
+    if (distance <= 0.0) {
+        return Color(0, 0, 0);
+    }
     
-    int rows_per_thread = height / num_threads;
+    double t = std::min(1.0, distance / (DISTANCE_SHADE_PIXELS * pixel_size));
+    unsigned char v = (unsigned char)(std::sqrt(t) * 255);
     
-    for (int t = 0; t < num_threads; t++) {
-        int start_row = t * rows_per_thread;
-        int end_row = (t == num_threads - 1) ? height : (t + 1) * rows_per_thread;
+    return Color(v, v, v);
+}
+
+// Julia renders sample the fixed -2..2 window around julia_c, Mandelbrot renders the view
+void MandelbrotGenerator::view_bounds(bool julia, double& view_x_min, double& view_x_max,
+                                      double& view_y_min, double& view_y_max) const {
+    view_x_min = julia ? -2.0 : x_min;
+    view_x_max = julia ? 2.0 : x_max;
+    view_y_min = julia ? -2.0 : y_min;
+    view_y_max = julia ? 2.0 : y_max;
+}
+
+Precision MandelbrotGenerator::render_precision(bool cuda, bool julia) const {
+    if (precision != Precision::AUTO) return precision;
+    
+    double view_x_min, view_x_max, view_y_min, view_y_max;
+    view_bounds(julia, view_x_min, view_x_max, view_y_min, view_y_max);
+    double spacing = std::min((view_x_max - view_x_min) / std::max(width - 1, 1),
+                              (view_y_max - view_y_min) / std::max(height - 1, 1));
+    // Orbits reach |z| = 2 wherever the view is
+    double scale = std::max({ 2.0, std::abs(view_x_min), std::abs(view_x_max), std::abs(view_y_min), std::abs(view_y_max) });
+    
+    if (cuda && spacing >= scale * FLT_EPSILON * PRECISION_MARGIN) return Precision::FLOAT;
+    if (spacing >= scale * DBL_EPSILON * PRECISION_MARGIN) return Precision::DOUBLE;
+    return Precision::DOUBLE_DOUBLE;
+}
+
+// Color of one sample point; distance receives its estimate in distance mode, iterations the
+// escape count
+template <class F, bool Julia, bool Distance, class T>
+Color MandelbrotGenerator::shade(T real, T imag, std::complex<double> julia_c, double pixel_size, double& distance,
+                                 int& iterations) {
+    if constexpr (Distance) {
+        iterations = escape_distance<F, Julia, T>(real, imag, T(julia_c.real()), T(julia_c.imag()), max_iterations, distance);
+        return distance_to_color(distance, pixel_size);
+    } else {
+        iterations = escape_iterations<F, Julia, T>(real, imag, T(julia_c.real()), T(julia_c.imag()), max_iterations);
+        return iterations_to_color(iterations);
+    }
+}
+
+// Iterates the task's pixels, one sample each, a tile column at a time so the cost of each tile
+// can be recorded. Returns how many pixels reached max_iterations.
+template <class F, bool Julia, bool Distance, class T>
+int MandelbrotGenerator::render_rows(std::vector<Color>& image, const std::vector<int>& rows, const RenderTask& task,
+                                     std::complex<double> julia_c) {
+    double view_x_min, view_x_max, view_y_min, view_y_max;
+    view_bounds(Julia, view_x_min, view_x_max, view_y_min, view_y_max);
+    double pixel_size = (view_x_max - view_x_min) / (width - 1);
+    int tile_columns = (width + tile_size - 1) / tile_size;
+    bool record = !row_cost.empty();
+    int interior = 0;
+    
+    for (int i = task.first; i < task.last && !cancelled(); i++) {
+        int y = rows[i];
+        T imag = plane_point<T>(view_y_min, (view_y_max - view_y_min) * y / (height - 1));
         
-        threads.emplace_back([this, &image, start_row, end_row]() {
-            for (int y = start_row; y < end_row; y++) {
-                for (int x = 0; x < width; x++) {
-                    double real = x_min + (x_max - x_min) * x / (width - 1);
-                    double imag = y_min + (y_max - y_min) * y / (height - 1);
-                    
-                    std::complex<double> c(real, imag);
-                    int iterations = mandelbrot_iterations(c);
-                    
-                    image[y * width + x] = iterations_to_color(iterations);
+        for (int tx = task.x_first / tile_size; tx * tile_size < task.x_last; tx++) {
+            long long cost = 0;
+            int x_end = std::min(task.x_last, (tx + 1) * tile_size);
+            
+            for (int x = std::max(task.x_first, tx * tile_size); x < x_end; x++) {
+                T real = plane_point<T>(view_x_min, (view_x_max - view_x_min) * x / (width - 1));
+                double distance;
+                int iterations;
+                image[y * width + x] = shade<F, Julia, Distance, T>(real, imag, julia_c, pixel_size, distance, iterations);
+                if constexpr (Distance) {
+                    distance_buffer[y * width + x] = distance;
                 }
+                cost += iterations;
+                interior += iterations == max_iterations;
             }
-        });
+            
+            if (record) {
+                row_cost[y * tile_columns + tx] += cost;
+            }
+        }
     }
     
-    for (auto& thread : threads) {
-        thread.join();
-    }
+    return interior;
 }
 
-void MandelbrotGenerator::generate_julia_serial(std::vector<Color>& image, std::complex<double> julia_c) {
-    // Julia set bounds
-    double julia_x_min = -2.0, julia_x_max = 2.0;
-    double julia_y_min = -2.0, julia_y_max = 2.0;
+// Largest channel difference between a pixel of base and its eight neighbours
+static int neighbour_contrast(const std::vector<Color>& base, int width, int height, int x, int y) {
+    const Color& center = base[y * width + x];
+    int contrast = 0;
+    
+    for (int ny = std::max(0, y - 1); ny <= std::min(height - 1, y + 1); ny++) {
+        for (int nx = std::max(0, x - 1); nx <= std::min(width - 1, x + 1); nx++) {
+            const Color& other = base[ny * width + nx];
+            contrast = std::max(contrast, std::abs(center.r - other.r));
+            contrast = std::max(contrast, std::abs(center.g - other.g));
+            contrast = std::max(contrast, std::abs(center.b - other.b));
+        }
+    }
     
-    for (int y = 0; y < height; y++) {
-        for (int x = 0; x < width; x++) {
-            double real = julia_x_min + (julia_x_max - julia_x_min) * x / (width - 1);
-            double imag = julia_y_min + (julia_y_max - julia_y_min) * y / (height - 1);
+    return contrast;
+}
+
+// Jitter in [0, 1) from a pixel and sample index: the same image on every run and thread count
+static double jitter(int x, int y, int sample) {
+    unsigned long long h = ((unsigned long long)(unsigned)x << 40) ^ ((unsigned long long)(unsigned)y << 16) ^ (unsigned)sample;
+    h += 0x9E3779B97F4A7C15ULL;
+    h = (h ^ (h >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    h = (h ^ (h >> 27)) * 0x94D049BB133111EBULL;
+    h ^= h >> 31;
+    return (h >> 11) * (1.0 / 9007199254740992.0);
+}
+
+// Adaptive anti-aliasing: pixels of the task whose color differs from a neighbour in base
+// by more than aa_threshold are resampled on an aa_grid x aa_grid stratified, jittered grid over
+// their footprint and averaged. The distance buffer keeps the center estimates. Returns how many
+// pixels were resampled.
+template <class F, bool Julia, bool Distance, class T>
+int MandelbrotGenerator::refine_rows(std::vector<Color>& image, const std::vector<Color>& base, const std::vector<int>& rows,
+                                     const RenderTask& task, std::complex<double> julia_c) {
+    double view_x_min, view_x_max, view_y_min, view_y_max;
+    view_bounds(Julia, view_x_min, view_x_max, view_y_min, view_y_max);
+    double step_x = (view_x_max - view_x_min) / (width - 1);
+    double step_y = (view_y_max - view_y_min) / (height - 1);
+    int samples = aa_grid * aa_grid;
+    int tile_columns = (width + tile_size - 1) / tile_size;
+    bool record = !row_cost.empty();
+    int refined = 0;
+    
+    for (int i = task.first; i < task.last && !cancelled(); i++) {
+        int y = rows[i];
+        
+        for (int x = task.x_first; x < task.x_last; x++) {
+            if (neighbour_contrast(base, width, height, x, y) <= aa_threshold) continue;
             
-            std::complex<double> z(real, imag);
-            int iterations = julia_iterations(z, julia_c);
+            int r = 0, g = 0, b = 0;
+            long long cost = 0;
+            for (int s = 0; s < samples; s++) {
+                double u = ((s % aa_grid) + jitter(x, y, 2 * s)) / aa_grid - 0.5;
+                double v = ((s / aa_grid) + jitter(x, y, 2 * s + 1)) / aa_grid - 0.5;
+                T real = plane_point<T>(view_x_min, step_x * (x + u));
+                T imag = plane_point<T>(view_y_min, step_y * (y + v));
+                double distance;
+                int iterations;
+                Color color = shade<F, Julia, Distance, T>(real, imag, julia_c, step_x, distance, iterations);
+                r += color.r;
+                g += color.g;
+                b += color.b;
+                cost += iterations;
+            }
             
-            image[y * width + x] = iterations_to_color(iterations);
+            image[y * width + x] = Color(r / samples, g / samples, b / samples);
+            refined++;
+            if (record) {
+                row_cost[y * tile_columns + x / tile_size] += cost;
+            }
         }
     }
+    
+    return refined;
 }
 
-void MandelbrotGenerator::generate_julia_parallel(std::vector<Color>& image, std::complex<double> julia_c) {
-    const int num_threads = std::thread::hardware_concurrency();
-    std::vector<std::thread> threads;
+// Runs task(0) .. task(count - 1) on num_threads workers, each taking the next unstarted task as
+// it frees up. With stats, adds each worker's busy time and its wait for the slowest one to the
+// thread counters.
+static void run_tasks(int count, int num_threads, const std::function<void(int)>& task, RenderStats* stats = nullptr) {
+    num_threads = std::max(1, std::min(num_threads, count));
+    std::vector<double> busy(num_threads, 0.0);
+    std::atomic<int> next(0);
+    auto start_time = std::chrono::steady_clock::now();
+    
+    auto worker = [&](int t) {
+        auto worker_start = std::chrono::steady_clock::now();
+        for (int i = next++; i < count; i = next++) {
+            task(i);
+        }
+        busy[t] = std::chrono::duration<double>(std::chrono::steady_clock::now() - worker_start).count();
+    };
     
-    int rows_per_thread = height / num_threads;
+    if (num_threads == 1) {
+        worker(0);
+    } else {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < num_threads; t++) {
+            threads.emplace_back(worker, t);
+        }
+        
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
     
+    if (!stats) return;
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+    stats->thread_busy.resize(std::max((int)stats->thread_busy.size(), num_threads), 0.0);
+    stats->thread_idle.resize(stats->thread_busy.size(), 0.0);
     for (int t = 0; t < num_threads; t++) {
-        int start_row = t * rows_per_thread;
-        int end_row = (t == num_threads - 1) ? height : (t + 1) * rows_per_thread;
+        stats->thread_busy[t] += busy[t];
+        stats->thread_idle[t] += std::max(0.0, wall - busy[t]);
+    }
+}
+
+// Splits the unique rows into tasks. BANDS: num_threads contiguous bands. TILES: tile_size
+// chunks of rows by tile_size columns in scan order. PREDICTED: the same tiles sorted costliest
+// first, so the long ones start early and the last tiles to finish are cheap ones.
+std::vector<MandelbrotGenerator::RenderTask> MandelbrotGenerator::plan_tasks(const std::vector<int>& rows, bool julia,
+                                                                            int num_threads) const {
+    int row_count = rows.size();
+    std::vector<RenderTask> tasks;
+    
+    if (schedule == Schedule::BANDS || num_threads <= 1) {
+        num_threads = std::max(num_threads, 1);
+        int per_thread = row_count / num_threads;
+        for (int t = 0; t < num_threads; t++) {
+            int end = (t == num_threads - 1) ? row_count : (t + 1) * per_thread;
+            tasks.push_back({ t * per_thread, end, 0, width, 0.0 });
+        }
+        return tasks;
+    }
+    
+    for (int first = 0; first < row_count; first += tile_size) {
+        for (int x = 0; x < width; x += tile_size) {
+            tasks.push_back({ first, std::min(row_count, first + tile_size), x, std::min(width, x + tile_size), 0.0 });
+        }
+    }
+    
+    bool history = !previous_frame.cost.empty() && previous_frame.julia == julia && previous_frame.fractal == fractal;
+    if (schedule == Schedule::PREDICTED && history) {
+        for (RenderTask& task : tasks) {
+            task.predicted = predicted_cost(task, rows, julia);
+        }
+        std::stable_sort(tasks.begin(), tasks.end(),
+                         [](const RenderTask& a, const RenderTask& b) { return a.predicted > b.predicted; });
+    }
+    
+    return tasks;
+}
+
+// Iterations the task is expected to take: the previous frame's cost per pixel at a 3x3 grid of
+// points over the task, looked up by plane position so pans and zooms still line up. Points the
+// previous frame did not cover get its mean.
+double MandelbrotGenerator::predicted_cost(const RenderTask& task, const std::vector<int>& rows, bool julia) const {
+    const CostMap& map = previous_frame;
+    double view_x_min, view_x_max, view_y_min, view_y_max;
+    view_bounds(julia, view_x_min, view_x_max, view_y_min, view_y_max);
+    
+    double density = 0.0;
+    for (int sy = 0; sy < 3; sy++) {
+        int y = rows[task.first + (task.last - 1 - task.first) * sy / 2];
+        double imag = view_y_min + (view_y_max - view_y_min) * y / (height - 1);
+        int py = (int)std::lround((imag - map.y_min) / (map.y_max - map.y_min) * (map.height - 1));
         
-        threads.emplace_back([this, &image, julia_c, start_row, end_row]() {
-            double julia_x_min = -2.0, julia_x_max = 2.0;
-            double julia_y_min = -2.0, julia_y_max = 2.0;
+        for (int sx = 0; sx < 3; sx++) {
+            int x = task.x_first + (task.x_last - 1 - task.x_first) * sx / 2;
+            double real = view_x_min + (view_x_max - view_x_min) * x / (width - 1);
+            int px = (int)std::lround((real - map.x_min) / (map.x_max - map.x_min) * (map.width - 1));
             
-            for (int y = start_row; y < end_row; y++) {
-                for (int x = 0; x < width; x++) {
-                    double real = julia_x_min + (julia_x_max - julia_x_min) * x / (width - 1);
-                    double imag = julia_y_min + (julia_y_max - julia_y_min) * y / (height - 1);
-                    
-                    std::complex<double> z(real, imag);
-                    int iterations = julia_iterations(z, julia_c);
-                    
-                    image[y * width + x] = iterations_to_color(iterations);
-                }
+            if (px < 0 || px >= map.width || py < 0 || py >= map.height) {
+                density += map.mean;
+                continue;
             }
+            int column = px / map.tile_size;
+            int column_width = std::min(map.tile_size, map.width - column * map.tile_size);
+            density += (double)map.cost[py * map.columns + column] / column_width;
+        }
+    }
+    
+    return density / 9.0 * (task.last - task.first) * (task.x_last - task.x_first);
+}
+
+// Keeps this frame's row costs for the next PREDICTED frame, with the mirrored rows filled in
+// from their source rows (column order reversed for 180 degree symmetry)
+void MandelbrotGenerator::remember_costs(int axis, bool julia) {
+    int columns = (width + tile_size - 1) / tile_size;
+    previous_frame.cost = row_cost;
+    
+    for (int y = 0; axis >= 0 && y < height; y++) {
+        int mirror = axis - y;
+        if (mirror < 0 || mirror >= y) continue;
+        
+        const long long* src = &row_cost[mirror * columns];
+        long long* dst = &previous_frame.cost[y * columns];
+        if (julia) {
+            std::reverse_copy(src, src + columns, dst);
+        } else {
+            std::copy(src, src + columns, dst);
+        }
+    }
+    
+    long long total = 0;
+    for (long long cost : previous_frame.cost) total += cost;
+    previous_frame.mean = (double)total / ((double)width * height);
+    previous_frame.width = width;
+    previous_frame.height = height;
+    previous_frame.tile_size = tile_size;
+    previous_frame.columns = columns;
+    view_bounds(julia, previous_frame.x_min, previous_frame.x_max, previous_frame.y_min, previous_frame.y_max);
+    previous_frame.julia = julia;
+    previous_frame.fractal = fractal;
+}
+
+// Shared body of the CPU generators: picks the formula and precision once, iterates the unique rows split into
+// tasks by the schedule, mirrors the symmetric half, then runs the anti-aliasing pass over the
+// same tasks
+void MandelbrotGenerator::render(std::vector<Color>& image, bool julia, std::complex<double> julia_c, int num_threads) {
+    auto start_time = std::chrono::steady_clock::now();
+    int axis = julia ? julia_axis() : conjugate_axis();
+    std::vector<int> rows = unique_rows(axis);
+    int row_count = rows.size();
+    int tile_columns = (width + tile_size - 1) / tile_size;
+    if (use_distance) {
+        distance_buffer.resize(width * height);
+    }
+    refined_pixels = 0;
+    stats = RenderStats();
+    RenderStats* task_stats = use_stats ? &stats : nullptr;
+    bool predicting = schedule == Schedule::PREDICTED && num_threads > 1;
+    if (use_stats || predicting) {
+        row_cost.assign((size_t)height * tile_columns, 0);
+    } else {
+        row_cost.clear();
+    }
+    std::vector<RenderTask> tasks = plan_tasks(rows, julia, num_threads);
+    int task_count = tasks.size();
+    std::atomic<int> interior(0);
+    
+    with_formula(fractal, [&](auto formula) {
+        with_precision(render_precision(false, julia), [&](auto scalar) {
+            using F = decltype(formula);
+            using T = decltype(scalar);
+            run_tasks(task_count, num_threads, [&](int t) {
+                int count;
+                if (julia && use_distance) {
+                    count = render_rows<F, true, true, T>(image, rows, tasks[t], julia_c);
+                } else if (julia) {
+                    count = render_rows<F, true, false, T>(image, rows, tasks[t], julia_c);
+                } else if (use_distance) {
+                    count = render_rows<F, false, true, T>(image, rows, tasks[t], julia_c);
+                } else {
+                    count = render_rows<F, false, false, T>(image, rows, tasks[t], julia_c);
+                }
+                interior += count;
+            }, task_stats);
+            mirror_rows(image, axis, julia);
+            
+            if (aa_grid < 2) return;
+            
+            const std::vector<Color> base = image;
+            std::atomic<int> refined(0);
+            run_tasks(task_count, num_threads, [&](int t) {
+                int count;
+                if (julia && use_distance) {
+                    count = refine_rows<F, true, true, T>(image, base, rows, tasks[t], julia_c);
+                } else if (julia) {
+                    count = refine_rows<F, true, false, T>(image, base, rows, tasks[t], julia_c);
+                } else if (use_distance) {
+                    count = refine_rows<F, false, true, T>(image, base, rows, tasks[t], julia_c);
+                } else {
+                    count = refine_rows<F, false, false, T>(image, base, rows, tasks[t], julia_c);
+                }
+                refined += count;
+            }, task_stats);
+            mirror_rows(image, axis, julia);
+            refined_pixels = refined;
         });
+    });
+    
+    if (use_distance) {
+        mirror_rows(distance_buffer, axis, julia);
+    }
+    if (predicting && !cancelled()) {
+        remember_costs(axis, julia);
+    }
+    
+    if (!use_stats) return;
+    stats.computed_pixels = row_count * width;
+    stats.interior_pixels = interior;
+    stats.skipped_pixels = (height - row_count) * width;
+    stats.refined_pixels = refined_pixels;
+    stats.tile_size = tile_size;
+    stats.tile_columns = tile_columns;
+    stats.tile_rows = (height + tile_size - 1) / tile_size;
+    stats.tile_cost.assign((size_t)stats.tile_rows * tile_columns, 0);
+    for (int y = 0; y < height; y++) {
+        for (int tx = 0; tx < tile_columns; tx++) {
+            long long cost = row_cost[y * tile_columns + tx];
+            stats.tile_cost[(y / tile_size) * tile_columns + tx] += cost;
+            stats.total_iterations += cost;
+        }
     }
+    stats.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+}
+
+void MandelbrotGenerator::save_cost_heatmap(const std::string& filename) {
+    if (stats.tile_cost.empty()) {
+        std::cerr << "Error: No instrumented render to export" << std::endl;
+        return;
+    }
+    
+    long long max_cost = std::max(1LL, *std::max_element(stats.tile_cost.begin(), stats.tile_cost.end()));
+    std::vector<Color> heatmap(width * height);
     
-    for (auto& thread : threads) {
-        thread.join();
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // black -> red -> yellow -> white
+            double t = 3.0 * stats.tile_cost[(y / stats.tile_size) * stats.tile_columns + x / stats.tile_size] / max_cost;
+            heatmap[y * width + x] = Color((unsigned char)(std::min(t, 1.0) * 255),
+                                           (unsigned char)(std::clamp(t - 1.0, 0.0, 1.0) * 255),
+                                           (unsigned char)(std::clamp(t - 2.0, 0.0, 1.0) * 255));
+        }
     }
+    
+    save_bmp(heatmap, filename);
+}
+
+void MandelbrotGenerator::generate_serial(std::vector<Color>& image) {
+    render(image, false, 0.0, 1);
+}
+
+void MandelbrotGenerator::generate_parallel_threads(std::vector<Color>& image) {
+    render(image, false, 0.0, thread_count());
+}
+
+void MandelbrotGenerator::generate_julia_serial(std::vector<Color>& image, std::complex<double> julia_c) {
+    render(image, true, julia_c, 1);
+}
+
+void MandelbrotGenerator::generate_julia_parallel(std::vector<Color>& image, std::complex<double> julia_c) {
+    render(image, true, julia_c, thread_count());
 }
 
 #ifdef USE_CUDA
@@ -229,7 +644,8 @@ void MandelbrotGenerator::generate_cuda(std::vector<Color>& image) {
         return;
     }
     
-    launch_mandelbrot_kernel(d_image, width, height, max_iterations, x_min, x_max, y_min, y_max);
+    launch_mandelbrot_kernel(d_image, width, height, max_iterations, x_min, x_max, y_min, y_max, (int)fractal,
+                             (int)render_precision(true));
     
     unsigned char* host_image = new unsigned char[width * height * 3];
     err = cudaMemcpy(host_image, d_image, image_size, cudaMemcpyDeviceToHost);
@@ -271,7 +687,7 @@ void MandelbrotGenerator::generate_julia_cuda(std::vector<Color>& image, std::co
     
     launch_julia_kernel(d_image, width, height, max_iterations, 
                        julia_x_min, julia_x_max, julia_y_min, julia_y_max,
-                       julia_c.real(), julia_c.imag());
+                       julia_c.real(), julia_c.imag(), (int)fractal, (int)render_precision(true, true));
     
     unsigned char* host_image = new unsigned char[width * height * 3];
     err = cudaMemcpy(host_image, d_image, image_size, cudaMemcpyDeviceToHost);
@@ -293,6 +709,15 @@ void MandelbrotGenerator::generate_julia_cuda(std::vector<Color>& image, std::co
 }
 #endif // USE_CUDA
 
+std::string MandelbrotGenerator::scene_key() const {
+    std::ostringstream key;
+    key << std::setprecision(17) << width << "x" << height << "_iter" << max_iterations << "_" << fractal_name(fractal)
+        << "_x" << x_min << "," << x_max << "_y" << y_min << "," << y_max
+        << (use_distance ? "_distance" : "_iterations") << "_aa" << aa_grid * aa_grid << "," << aa_threshold
+        << (use_symmetry ? "_sym" : "_nosym") << "_" << precision_name(render_precision(false));
+    return key.str();
+}
+
 void MandelbrotGenerator::save_bmp(const std::vector<Color>& image, const std::string& filename) {
     std::ofstream file(filename, std::ios::binary);
     if (!file) {
@@ -353,12 +778,140 @@ void MandelbrotGenerator::save_bmp(const std::vector<Color>& image, const std::s
 }
 
 double benchmark_function(const std::function<void()>& func) {
-    auto start = std::chrono::high_resolution_clock::now();
+    auto start = std::chrono::steady_clock::now();
     func();
-    auto end = std::chrono::high_resolution_clock::now();
+    auto end = std::chrono::steady_clock::now();
     
-    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start);
-    return duration.count() / 1000.0;
+    return std::chrono::duration<double>(end - start).count();
+}
+
+void print_render_stats(const RenderStats& stats, std::ostream& out) {
+    int threads = stats.thread_busy.size();
+    double busy_total = 0.0, busy_max = 0.0, idle_total = 0.0;
+    for (int t = 0; t < threads; t++) {
+        busy_total += stats.thread_busy[t];
+        busy_max = std::max(busy_max, stats.thread_busy[t]);
+        idle_total += stats.thread_idle[t];
+    }
+    
+    out << "=== Render Statistics ===" << std::endl;
+    out << "Total iterations: " << stats.total_iterations << std::endl;
+    out << "Pixels computed: " << stats.computed_pixels << " (interior " << stats.interior_pixels
+              << ", anti-aliased " << stats.refined_pixels << ")" << std::endl;
+    out << "Pixels skipped by symmetry: " << stats.skipped_pixels << std::endl;
+    if (threads > 0 && busy_total > 0.0) {
+        // slowest worker against the mean: 1.00 is a perfect split
+        out << std::setprecision(4) << "Threads: " << threads << ", busy " << busy_total << " s, idle " << idle_total
+                  << " s, imbalance " << busy_max / (busy_total / threads) << "x" << std::endl;
+    }
+    if (!stats.tile_cost.empty()) {
+        long long max_cost = *std::max_element(stats.tile_cost.begin(), stats.tile_cost.end());
+        out << "Tiles: " << stats.tile_columns << "x" << stats.tile_rows << " of " << stats.tile_size
+                  << " px, costliest " << max_cost << " iterations, mean "
+                  << stats.total_iterations / (long long)stats.tile_cost.size() << std::endl;
+    }
+}
+
+static const char* FRACTAL_NAMES[] = { "mandelbrot", "multibrot3", "multibrot4", "burningship", "tricorn" };
+
+const char* fractal_name(FractalType type) {
+    int index = (int)type;
+    if (index < 0 || index >= (int)FractalType::FRACTAL_COUNT) return "unknown";
+    return FRACTAL_NAMES[index];
+}
+
+bool parse_fractal(const std::string& name, FractalType& type) {
+    for (int i = 0; i < (int)FractalType::FRACTAL_COUNT; i++) {
+        if (name == FRACTAL_NAMES[i]) {
+            type = (FractalType)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char* SCHEDULE_NAMES[] = { "bands", "tiles", "predicted" };
+
+const char* schedule_name(Schedule mode) {
+    return SCHEDULE_NAMES[(int)mode];
+}
+
+bool parse_schedule(const std::string& name, Schedule& mode) {
+    for (int i = 0; i < 3; i++) {
+        if (name == SCHEDULE_NAMES[i]) {
+            mode = (Schedule)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char* PRECISION_NAMES[] = { "auto", "float", "double", "doubledouble" };
+
+const char* precision_name(Precision mode) {
+    return PRECISION_NAMES[(int)mode];
+}
+
+bool parse_precision(const std::string& name, Precision& mode) {
+    for (int i = 0; i < (int)Precision::PRECISION_COUNT; i++) {
+        if (name == PRECISION_NAMES[i]) {
+            mode = (Precision)i;
+            return true;
+        }
+    }
+    return false;
+}
+
+static const char* BACKEND_NAMES[] = { "serial", "parallel", "cuda" };
+
+const char* backend_name(Backend backend) {
+    return BACKEND_NAMES[(int)backend];
+}
+
+bool parse_backends(const std::string& list, std::vector<bool>& selected) {
+    selected.assign((int)Backend::BACKEND_COUNT, false);
+    std::stringstream ss(list);
+    std::string name;
+    
+    while (std::getline(ss, name, ',')) {
+        int i = 0;
+        while (i < (int)Backend::BACKEND_COUNT && name != BACKEND_NAMES[i]) i++;
+        if (i == (int)Backend::BACKEND_COUNT) return false;
+        selected[i] = true;
+    }
+    return true;
+}
+
+BaselineCache::BaselineCache(const std::string& file) : path(file) {
+    std::ifstream in(path);
+    std::string backend, scene;
+    double time;
+    
+    while (in >> backend >> time >> scene) {
+        seconds[backend + " " + scene] = time;
+    }
+}
+
+bool BaselineCache::lookup(const std::string& scene, Backend backend, double& time) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto entry = seconds.find(std::string(backend_name(backend)) + " " + scene);
+    if (entry == seconds.end()) return false;
+    
+    time = entry->second;
+    return true;
+}
+
+// Appends, so the latest measurement of a scene wins on the next load
+void BaselineCache::store(const std::string& scene, Backend backend, double time) {
+    std::lock_guard<std::mutex> lock(mutex);
+    seconds[std::string(backend_name(backend)) + " " + scene] = time;
+    
+    std::ofstream out(path, std::ios::app);
+    if (!out) {
+        std::cerr << "Error: Cannot write baseline cache " << path << std::endl;
+        return;
+    }
+    out << backend_name(backend) << " " << std::setprecision(9) << time << " " << scene << std::endl;
 }
 
 void print_system_info() {
@@ -6,6 +6,12 @@
 #include <string>
 #include <functional>
 #include <thread>
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <atomic>
+#include <iostream>
+#include "fractal_kernels.h"
 
 struct Color {
     unsigned char r, g, b;
@@ -14,21 +20,137 @@ struct Color {
         : r(red), g(green), b(blue) {}
 };
 
+// How the CPU generators split a frame between their threads
+enum class Schedule {
+    BANDS,        // one contiguous band of rows per thread
+    TILES,        // tile_size x tile_size tiles, handed out in scan order as threads free up
+    PREDICTED     // tiles handed out costliest first, costs predicted from the previous frame (default)
+};
+
+// Counters of the last CPU render, collected when instrumentation is on
+struct RenderStats {
+    long long total_iterations;             // escape iterations of every sample, anti-aliasing included
+    int computed_pixels;                    // pixels iterated
+    int interior_pixels;                    // computed pixels that reached max_iterations
+    int skipped_pixels;                     // pixels mirrored from the symmetric half instead
+    int refined_pixels;                     // pixels resampled by anti-aliasing
+    double wall_seconds;
+    std::vector<double> thread_busy;        // seconds each worker spent rendering, all passes
+    std::vector<double> thread_idle;        // seconds each worker waited for the slowest one
+    int tile_size, tile_columns, tile_rows;
+    std::vector<long long> tile_cost;       // iterations per tile, row-major
+    RenderStats() : total_iterations(0), computed_pixels(0), interior_pixels(0), skipped_pixels(0),
+                    refined_pixels(0), wall_seconds(0.0), tile_size(0), tile_columns(0), tile_rows(0) {}
+};
+
 class MandelbrotGenerator {
 private:
     int width, height;
     int max_iterations;
     double x_min, x_max, y_min, y_max;
+    bool use_symmetry;
+    FractalType fractal;
+    bool use_distance;
+    std::vector<double> distance_buffer;
+    int aa_grid, aa_threshold;
+    int refined_pixels;
+    int num_threads;
+    int tile_size;
+    bool use_stats;
+    RenderStats stats;
+    std::vector<long long> row_cost;    // iterations per (row, tile column), each cell is owned by one task
+    Schedule schedule;
+    Precision precision;
+    const std::atomic<bool>* cancel_flag;
+    
+    // Unique rows [first, last) x columns [x_first, x_last), one scheduling unit
+    struct RenderTask {
+        int first, last, x_first, x_last;
+        double predicted;
+    };
+    // Cost map of the previous frame, mirrored halves filled in, for PREDICTED scheduling
+    struct CostMap {
+        std::vector<long long> cost;    // per (row, tile column), as row_cost
+        double mean;                    // iterations per pixel over the whole frame
+        int width, height, tile_size, columns;
+        double x_min, x_max, y_min, y_max;
+        bool julia;
+        FractalType fractal;
+    };
+    CostMap previous_frame;
+    
+    // Symmetry: rows y and axis - y are mirror images, only one of each pair is iterated
+    int conjugate_axis() const;
+    int julia_axis() const;
+    std::vector<int> unique_rows(int axis) const;
+    template <class T>
+    void mirror_rows(std::vector<T>& buffer, int axis, bool rotate);
+    
+    // Shared CPU path, instantiated once per formula and shading
+    void view_bounds(bool julia, double& view_x_min, double& view_x_max, double& view_y_min, double& view_y_max) const;
+    template <class F, bool Julia, bool Distance, class T>
+    Color shade(T real, T imag, std::complex<double> julia_c, double pixel_size, double& distance, int& iterations);
+    template <class F, bool Julia, bool Distance, class T>
+    int render_rows(std::vector<Color>& image, const std::vector<int>& rows, const RenderTask& task,
+                    std::complex<double> julia_c);
+    template <class F, bool Julia, bool Distance, class T>
+    int refine_rows(std::vector<Color>& image, const std::vector<Color>& base, const std::vector<int>& rows,
+                    const RenderTask& task, std::complex<double> julia_c);
+    std::vector<RenderTask> plan_tasks(const std::vector<int>& rows, bool julia, int num_threads) const;
+    double predicted_cost(const RenderTask& task, const std::vector<int>& rows, bool julia) const;
+    void remember_costs(int axis, bool julia);
+    void render(std::vector<Color>& image, bool julia, std::complex<double> julia_c, int num_threads);
+    bool cancelled() const { return cancel_flag && cancel_flag->load(std::memory_order_relaxed); }
     
 public:
     MandelbrotGenerator(int w, int h, int max_iter = 1000);
     
     void set_bounds(double xmin, double xmax, double ymin, double ymax);
+    // Mirror symmetric halves instead of iterating them (on by default)
+    void set_symmetry(bool enabled) { use_symmetry = enabled; }
+    // Formula used by every backend (Mandelbrot by default)
+    void set_fractal(FractalType type) { fractal = type; }
+    FractalType get_fractal() const { return fractal; }
+    // Exterior distance estimation in the CPU generators: boundaries stay sharp at low iteration
+    // counts. Fills get_distance_buffer() (plane units, 0 inside) and shades by distance.
+    void set_distance_estimation(bool enabled) { use_distance = enabled; }
+    const std::vector<double>& get_distance_buffer() const { return distance_buffer; }
+    // Adaptive anti-aliasing in the CPU generators: after the one-sample pass, pixels whose color
+    // differs from a neighbour by more than threshold (max channel difference, 0-255) are
+    // resampled with `samples` jittered samples, rounded down to a square (16 = 4x4). A negative
+    // threshold resamples every pixel (plain supersampling). samples < 4 turns it off.
+    void set_antialiasing(int samples, int threshold = 16);
+    int get_refined_pixels() const { return refined_pixels; }
+    // Worker threads of the parallel generators, 0 = one per hardware thread (the default)
+    void set_threads(int threads) { num_threads = threads; }
+    int thread_count() const;
+    // Instrumentation of the CPU generators: iteration, pixel and per-thread counters plus the
+    // iteration cost of every tile_size x tile_size tile, read back with get_stats() (off by default)
+    void set_instrumentation(bool enabled) { use_stats = enabled; }
+    const RenderStats& get_stats() const { return stats; }
+    void set_tile_size(int size) { tile_size = std::max(size, 1); }
+    // Work split of the parallel generators (PREDICTED by default, see Schedule)
+    void set_schedule(Schedule mode) { schedule = mode; }
+    Schedule get_schedule() const { return schedule; }
+    // Arithmetic of the escape loops. AUTO (the default) takes the cheapest precision whose
+    // rounding stays well below the view's pixel spacing: float on the GPU, where it runs many
+    // times faster than double, double on the CPU, where scalar float is no faster, and
+    // double-double on both once the spacing nears double's rounding step
+    void set_precision(Precision mode) { precision = mode; }
+    Precision get_precision() const { return precision; }
+    // The precision a render of the current view runs in, AUTO resolved
+    Precision render_precision(bool cuda, bool julia = false) const;
+    // CPU renders stop within a row once *flag turns true, leaving the image unfinished
+    // (nullptr, the default, never stops)
+    void set_cancel_flag(const std::atomic<bool>* flag) { cancel_flag = flag; }
+    // Tile costs of the last instrumented render as an image, black (cheapest) to white (costliest)
+    void save_cost_heatmap(const std::string& filename);
     
     int mandelbrot_iterations(std::complex<double> c);
     int julia_iterations(std::complex<double> z, std::complex<double> c);
     
     Color iterations_to_color(int iterations);
+    Color distance_to_color(double distance, double pixel_size);
     
     // CPU implementations
     void generate_serial(std::vector<Color>& image);
@@ -49,19 +171,56 @@ public:
     int get_width() const { return width; }
     int get_height() const { return height; }
     int get_max_iterations() const { return max_iterations; }
+    // Everything that decides a Mandelbrot render's cost (size, iterations, formula, view,
+    // shading, anti-aliasing, symmetry, precision), as one token for BaselineCache
+    std::string scene_key() const;
+};
+
+// Backends the front ends can benchmark
+enum class Backend {
+    SERIAL = 0,
+    PARALLEL,
+    CUDA,
+    BACKEND_COUNT
+};
+
+// Timings per scene and backend, kept in a text file so a slow baseline is measured once per
+// scene and reused by later runs. Safe to use from a background thread.
+class BaselineCache {
+private:
+    std::string path;
+    std::map<std::string, double> seconds;    // "backend scene" -> seconds
+    std::mutex mutex;
+    
+public:
+    explicit BaselineCache(const std::string& file);
+    
+    bool lookup(const std::string& scene, Backend backend, double& time);
+    void store(const std::string& scene, Backend backend, double time);
 };
 
 // Utility functions
 double benchmark_function(const std::function<void()>& func);
 void print_system_info();
+void print_render_stats(const RenderStats& stats, std::ostream& out = std::cout);
+const char* fractal_name(FractalType type);
+bool parse_fractal(const std::string& name, FractalType& type);
+const char* schedule_name(Schedule mode);
+const char* backend_name(Backend backend);
+// Comma-separated backend names ("serial,parallel,cuda") into selected[Backend]
+bool parse_backends(const std::string& list, std::vector<bool>& selected);
+bool parse_schedule(const std::string& name, Schedule& mode);
+const char* precision_name(Precision mode);
+bool parse_precision(const std::string& name, Precision& mode);
 
 // CUDA wrapper functions
 #ifdef USE_CUDA
 extern "C" void launch_mandelbrot_kernel(unsigned char* d_image, int width, int height, int max_iterations,
-                                         double x_min, double x_max, double y_min, double y_max);
+                                         double x_min, double x_max, double y_min, double y_max, int fractal,
+                                         int precision);
 extern "C" void launch_julia_kernel(unsigned char* d_image, int width, int height, int max_iterations,
                                     double x_min, double x_max, double y_min, double y_max,
-                                    double c_real, double c_imag);
+                                    double c_real, double c_imag, int fractal, int precision);
 #endif
 
 #endif // MANDELBROT_H
\ No newline at end of file
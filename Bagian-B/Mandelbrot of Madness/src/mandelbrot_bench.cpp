@@ -0,0 +1,330 @@
+#include "mandelbrot.h"
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <algorithm>
+#include <cstdlib>
+#include <cstdio>
+#include <cmath>
+
+// Fixed scene catalog: the same views on every build, so numbers can be compared across commits
+struct Scene {
+    const char* name;
+    FractalType fractal;
+    bool julia;
+    double c_real, c_imag;          // Julia constant
+    double center_x, center_y;      // Mandelbrot view center
+    double view_width;              // Mandelbrot view width, the height follows the image aspect
+    int max_iterations;
+};
+
+static const Scene SCENES[] = {
+    { "default",        FractalType::MANDELBROT, false, 0.0, 0.0, -0.5, 0.0, 4.0, 1000 },
+    { "seahorse",       FractalType::MANDELBROT, false, 0.0, 0.0, -0.745, 0.105, 0.03, 2000 },
+    { "deep_zoom",      FractalType::MANDELBROT, false, 0.0, 0.0, -0.743643887037151, 0.131825904205330, 2e-9, 4000 },
+    // Pixel spacing below double's rounding step at 800 px: only double-double resolves it
+    { "ultra_deep",     FractalType::MANDELBROT, false, 0.0, 0.0, -0.743643887037151, 0.131825904205330, 4e-13, 4000 },
+    { "julia_dendrite", FractalType::MANDELBROT, true, 0.0, 1.0, 0.0, 0.0, 4.0, 1000 },
+    { "interior",       FractalType::MANDELBROT, false, 0.0, 0.0, -0.2, 0.0, 0.6, 2000 },
+};
+static const int SCENE_COUNT = sizeof(SCENES) / sizeof(SCENES[0]);
+
+struct BenchResult {
+    std::string scene, backend, precision;
+    int threads;
+    long long median_ns, p95_ns, min_ns;
+    double pixels_per_second, iterations_per_second;
+};
+
+static void apply_scene(MandelbrotGenerator& generator, const Scene& scene, int width, int height) {
+    double view_height = scene.view_width * height / width;
+    generator.set_bounds(scene.center_x - scene.view_width / 2, scene.center_x + scene.view_width / 2,
+                         scene.center_y - view_height / 2, scene.center_y + view_height / 2);
+    generator.set_fractal(scene.fractal);
+}
+
+// Iterations the whole image takes without symmetry shortcuts, so iterations/s is the effective rate.
+// Counted in double, so approximate for scenes double cannot resolve.
+static long long scene_iterations(MandelbrotGenerator& generator, const Scene& scene, int width, int height) {
+    double view_height = scene.view_width * height / width;
+    double x_min = scene.julia ? -2.0 : scene.center_x - scene.view_width / 2;
+    double x_max = scene.julia ? 2.0 : scene.center_x + scene.view_width / 2;
+    double y_min = scene.julia ? -2.0 : scene.center_y - view_height / 2;
+    double y_max = scene.julia ? 2.0 : scene.center_y + view_height / 2;
+    std::complex<double> c(scene.c_real, scene.c_imag);
+    long long total = 0;
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            std::complex<double> point(x_min + (x_max - x_min) * x / (width - 1), y_min + (y_max - y_min) * y / (height - 1));
+            total += scene.julia ? generator.julia_iterations(point, c) : generator.mandelbrot_iterations(point);
+        }
+    }
+
+    return total;
+}
+
+// Nearest-rank percentile of sorted samples
+static long long percentile(const std::vector<long long>& sorted, double p) {
+    size_t rank = (size_t)std::max(1.0, std::ceil(p * sorted.size()));
+    return sorted[std::min(rank, sorted.size()) - 1];
+}
+
+static BenchResult run_backend(MandelbrotGenerator& generator, const Scene& scene, const std::string& backend, int threads,
+                               int width, int height, int warmup, int reps, long long iterations) {
+    std::vector<Color> image(width * height);
+    std::complex<double> c(scene.c_real, scene.c_imag);
+    generator.set_threads(threads);
+
+    auto render = [&]() {
+        if (backend == "serial") {
+            scene.julia ? generator.generate_julia_serial(image, c) : generator.generate_serial(image);
+        } else if (backend == "threads") {
+            scene.julia ? generator.generate_julia_parallel(image, c) : generator.generate_parallel_threads(image);
+        }
+        #ifdef USE_CUDA
+        else if (backend == "cuda") {
+            scene.julia ? generator.generate_julia_cuda(image, c) : generator.generate_cuda(image);
+        }
+        #endif
+    };
+
+    for (int i = 0; i < warmup; i++) {
+        render();
+    }
+
+    std::vector<long long> samples;
+    for (int i = 0; i < reps; i++) {
+        auto start = std::chrono::steady_clock::now();
+        render();
+        auto end = std::chrono::steady_clock::now();
+        samples.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(end - start).count());
+    }
+    std::sort(samples.begin(), samples.end());
+
+    BenchResult result;
+    result.scene = scene.name;
+    result.backend = backend;
+    result.precision = precision_name(generator.render_precision(backend == "cuda", scene.julia));
+    result.threads = backend == "threads" ? generator.thread_count() : 1;
+    result.median_ns = percentile(samples, 0.5);
+    result.p95_ns = percentile(samples, 0.95);
+    result.min_ns = samples.front();
+    result.pixels_per_second = (double)width * height / (result.median_ns * 1e-9);
+    result.iterations_per_second = iterations / (result.median_ns * 1e-9);
+    return result;
+}
+
+static std::vector<std::string> split(const std::string& list) {
+    std::vector<std::string> items;
+    std::stringstream ss(list);
+    std::string item;
+    while (std::getline(ss, item, ',')) {
+        if (!item.empty()) items.push_back(item);
+    }
+    return items;
+}
+
+static void write_json(std::ostream& out, const std::vector<BenchResult>& results, int width, int height, int warmup, int reps,
+                       bool symmetry, Schedule schedule, int tile_size) {
+    out << "{\n";
+    out << "  \"width\": " << width << ", \"height\": " << height << ", \"warmup\": " << warmup << ", \"reps\": " << reps << ",\n";
+    out << "  \"symmetry\": " << (symmetry ? "true" : "false") << ", \"schedule\": \"" << schedule_name(schedule)
+        << "\", \"tile\": " << tile_size << ",\n";
+    out << "  \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    #ifdef USE_CUDA
+    out << "  \"cuda_build\": true,\n";
+    #else
+    out << "  \"cuda_build\": false,\n";
+    #endif
+    out << "  \"results\": [";
+    for (size_t i = 0; i < results.size(); i++) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"scene\": \"" << r.scene << "\", \"backend\": \"" << r.backend
+            << "\", \"precision\": \"" << r.precision << "\", \"threads\": " << r.threads << ", \"median_ns\": " << r.median_ns << ", \"p95_ns\": " << r.p95_ns
+            << ", \"min_ns\": " << r.min_ns << std::fixed << std::setprecision(0)
+            << ", \"pixels_per_s\": " << r.pixels_per_second << ", \"iterations_per_s\": " << r.iterations_per_second << "}";
+        out.unsetf(std::ios::fixed);
+    }
+    out << "\n  ]\n}\n";
+}
+
+static void print_usage(const char* program) {
+    std::cout << "Usage: " << program << " [options]" << std::endl;
+    std::cout << "  --size WxH          image size (default 800x600)" << std::endl;
+    std::cout << "  --reps N            timed runs per case (default 5)" << std::endl;
+    std::cout << "  --warmup N          untimed runs first (default 1)" << std::endl;
+    std::cout << "  --scenes a,b        subset of: ";
+    for (int i = 0; i < SCENE_COUNT; i++) std::cout << (i ? "," : "") << SCENES[i].name;
+    std::cout << std::endl;
+    std::cout << "  --backends a,b      serial,threads,cuda (default: all available)" << std::endl;
+    std::cout << "  --threads 1,2,4     thread counts for the threads backend (default: hardware)" << std::endl;
+    std::cout << "  --precision a,b     auto (default), float, double, doubledouble; one run per entry" << std::endl;
+    std::cout << "  --json FILE         also write the results as JSON (- for stdout, the report moves to stderr)" << std::endl;
+    std::cout << "  --schedule MODE     bands, tiles or predicted (default) work split of the threads backend" << std::endl;
+    std::cout << "  --tile N            tile edge in pixels for tiles / predicted (default 32)" << std::endl;
+    std::cout << "  --no-symmetry       iterate both mirror halves (CPU backends)" << std::endl;
+    std::cout << "  --stats             print render counters of each scene (one extra threads render)" << std::endl;
+    std::cout << "  --heatmap DIR       save each scene's tile cost map as DIR/cost_<scene>.bmp" << std::endl;
+}
+
+int main(int argc, char* argv[]) {
+    int width = 800, height = 600, reps = 5, warmup = 1;
+    std::vector<std::string> scene_names, backends = { "serial", "threads" };
+    std::vector<int> thread_counts = { 0 };
+    std::vector<Precision> precisions = { Precision::AUTO };
+    std::string json_path;
+    bool symmetry = true, show_stats = false;
+    Schedule schedule = Schedule::PREDICTED;
+    int tile_size = 32;
+    std::string heatmap_dir;
+    #ifdef USE_CUDA
+    backends.push_back("cuda");
+    #endif
+
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        bool has_value = i + 1 < argc;
+        if (arg == "--size" && has_value) {
+            if (std::sscanf(argv[++i], "%dx%d", &width, &height) != 2) width = 0;
+        } else if (arg == "--reps" && has_value) {
+            reps = std::atoi(argv[++i]);
+        } else if (arg == "--warmup" && has_value) {
+            warmup = std::atoi(argv[++i]);
+        } else if (arg == "--scenes" && has_value) {
+            scene_names = split(argv[++i]);
+        } else if (arg == "--backends" && has_value) {
+            backends = split(argv[++i]);
+        } else if (arg == "--threads" && has_value) {
+            thread_counts.clear();
+            for (const std::string& t : split(argv[++i])) thread_counts.push_back(std::atoi(t.c_str()));
+        } else if (arg == "--precision" && has_value) {
+            precisions.clear();
+            for (const std::string& name : split(argv[++i])) {
+                Precision mode;
+                if (!parse_precision(name, mode)) {
+                    std::cerr << "Error: Unknown precision " << name << std::endl;
+                    return 1;
+                }
+                precisions.push_back(mode);
+            }
+        } else if (arg == "--json" && has_value) {
+            json_path = argv[++i];
+        } else if (arg == "--schedule" && has_value) {
+            std::string name = argv[++i];
+            if (!parse_schedule(name, schedule)) {
+                std::cerr << "Error: Unknown schedule " << name << std::endl;
+                return 1;
+            }
+        } else if (arg == "--tile" && has_value) {
+            tile_size = std::atoi(argv[++i]);
+        } else if (arg == "--no-symmetry") {
+            symmetry = false;
+        } else if (arg == "--stats") {
+            show_stats = true;
+        } else if (arg == "--heatmap" && has_value) {
+            heatmap_dir = argv[++i];
+        } else {
+            print_usage(argv[0]);
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    if (width < 2 || height < 2 || width > 8000 || height > 8000 || reps < 1 || warmup < 0 || thread_counts.empty() || precisions.empty() || tile_size < 1) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    for (const std::string& backend : backends) {
+        if (backend != "serial" && backend != "threads" && backend != "cuda") {
+            std::cerr << "Error: Unknown backend " << backend << std::endl;
+            return 1;
+        }
+        #ifndef USE_CUDA
+        if (backend == "cuda") {
+            std::cerr << "Error: Built without CUDA" << std::endl;
+            return 1;
+        }
+        #endif
+    }
+
+    std::vector<const Scene*> scenes;
+    for (int i = 0; i < SCENE_COUNT; i++) {
+        if (scene_names.empty() || std::find(scene_names.begin(), scene_names.end(), SCENES[i].name) != scene_names.end()) {
+            scenes.push_back(&SCENES[i]);
+        }
+    }
+    if (scenes.size() < std::max<size_t>(scene_names.size(), 1)) {
+        std::cerr << "Error: Unknown scene in the --scenes list" << std::endl;
+        return 1;
+    }
+
+    // JSON on stdout must be the only thing there
+    std::ostream& report = json_path == "-" ? std::cerr : std::cout;
+    report << "=== Mandelbrot Benchmark Suite ===" << std::endl;
+    report << "Resolution: " << width << "x" << height << ", warmup " << warmup << ", reps " << reps << std::endl;
+    report << "Schedule: " << schedule_name(schedule) << ", tile " << tile_size << " px" << std::endl;
+    report << std::endl;
+
+    std::vector<BenchResult> results;
+    report << std::left << std::setw(16) << "scene" << std::setw(9) << "backend" << std::setw(14) << "precision" << std::right << std::setw(8) << "threads"
+              << std::setw(13) << "median (ms)" << std::setw(11) << "p95 (ms)" << std::setw(12) << "Mpx/s" << std::setw(12) << "Giter/s" << std::endl;
+
+    for (const Scene* scene : scenes) {
+        MandelbrotGenerator generator(width, height, scene->max_iterations);
+        apply_scene(generator, *scene, width, height);
+        generator.set_symmetry(symmetry);
+        generator.set_schedule(schedule);
+        generator.set_tile_size(tile_size);
+        long long iterations = scene_iterations(generator, *scene, width, height);
+
+        for (const std::string& backend : backends) {
+            std::vector<int> counts = backend == "threads" ? thread_counts : std::vector<int>{ 1 };
+            for (Precision precision : precisions) {
+                generator.set_precision(precision);
+                for (int threads : counts) {
+                    BenchResult r = run_backend(generator, *scene, backend, threads, width, height, warmup, reps, iterations);
+                    results.push_back(r);
+                    report << std::left << std::setw(16) << r.scene << std::setw(9) << r.backend << std::setw(14) << r.precision
+                              << std::right << std::setw(8) << r.threads << std::fixed << std::setprecision(3) << std::setw(13)
+                              << r.median_ns * 1e-6 << std::setw(11) << r.p95_ns * 1e-6 << std::setprecision(2) << std::setw(12)
+                              << r.pixels_per_second * 1e-6 << std::setw(12) << r.iterations_per_second * 1e-9 << std::endl;
+                }
+            }
+        }
+        generator.set_precision(precisions.front());
+        
+        // Outside the timed runs: instrumentation costs a little
+        if (show_stats || !heatmap_dir.empty()) {
+            std::vector<Color> image(width * height);
+            generator.set_threads(thread_counts.back());
+            generator.set_instrumentation(true);
+            scene->julia ? generator.generate_julia_parallel(image, std::complex<double>(scene->c_real, scene->c_imag))
+                         : generator.generate_parallel_threads(image);
+            generator.set_instrumentation(false);
+            
+            report.unsetf(std::ios::fixed);
+            report << std::setprecision(4) << std::endl << "Scene: " << scene->name << std::endl;
+            if (show_stats) print_render_stats(generator.get_stats(), report);
+            if (!heatmap_dir.empty()) generator.save_cost_heatmap(heatmap_dir + "/cost_" + scene->name + ".bmp");
+            report << std::endl;
+        }
+    }
+
+    if (json_path == "-") {
+        write_json(std::cout, results, width, height, warmup, reps, symmetry, schedule, tile_size);
+    } else if (!json_path.empty()) {
+        std::ofstream file(json_path);
+        if (!file) {
+            std::cerr << "Error: Cannot create file " << json_path << std::endl;
+            return 1;
+        }
+        write_json(file, results, width, height, warmup, reps, symmetry, schedule, tile_size);
+        std::cout << std::endl << "JSON saved: " << json_path << std::endl;
+    }
+
+    return 0;
+}
@@ -19,10 +19,13 @@ MandelbrotGUI::MandelbrotGUI()
       original_x_min(-2.5), original_x_max(1.5), original_y_min(-2.0), original_y_max(2.0),
       mini_julia_enabled(true), last_mouse_pos(-1, -1), hover_julia_constant(0, 0),
       julia_rendered(false), julia_mouse_pos(400, 300),
-      generator(nullptr), cuda_result(), rendering_in_progress(false),
+      generator(nullptr), view_result(), view_method(RenderMethod::PARALLEL_CPU), rendering_in_progress(false),
       is_dragging(false), is_selecting_zoom(false), drag_start(0, 0), current_mouse_pos(0, 0), is_zoom_changed(false), zoom_factor(1.0f),
       julia_constant(-0.7, 0.27015),
-      cuda_available(false), font_loaded(false) {
+      cuda_available(false), font_loaded(false), fractal_type(FractalType::MANDELBROT),
+      selected_backends((int)Backend::BACKEND_COUNT, true), method_times(),
+      baseline_cache("../output/baseline_cache.txt"), baseline_done(false), baseline_cancel(false),
+      baseline_running(false), baseline_contended(false) {
     
     input_strings[0] = std::to_string(DEFAULT_WIDTH);
     input_strings[1] = std::to_string(DEFAULT_HEIGHT);
@@ -35,10 +38,12 @@ MandelbrotGUI::MandelbrotGUI()
     cuda_available = check_cuda_availability();
     
     std::cout << "=== Mandelbrot CUDA Generator ===" << std::endl;
-    std::cout << "CUDA Support: " << (cuda_available ? "YES" : "NO") << std::endl;
+    std::cout << "CUDA Support: " << (cuda_available ? "YES" : "NO (interactive view on the parallel CPU engine)") << std::endl;
 }
 
 MandelbrotGUI::~MandelbrotGUI() {
+    finish_baseline(true);
+    
     if (generator) {
         #ifdef USE_CUDA
         if (cuda_available) {
@@ -126,6 +131,12 @@ void MandelbrotGUI::setup_all_text_elements() {
     render_text.setPosition(350, 415);
     if (font_loaded) render_text.setFont(font);
     
+    backends_text.setCharacterSize(14);
+    backends_text.setFillColor(sf::Color(180, 200, 220));
+    backends_text.setPosition(190, 462);
+    if (font_loaded) backends_text.setFont(font);
+    update_backends_text();
+    
     status_text.setString("Ready to render");
     status_text.setCharacterSize(16);
     status_text.setFillColor(sf::Color::White);
@@ -191,6 +202,8 @@ void MandelbrotGUI::handle_events() {
 }
 
 void MandelbrotGUI::update() {
+    finish_baseline(false);
+    
     if (rendering_in_progress) {
         print_benchmark_header();
         render_all_methods();
@@ -254,10 +267,11 @@ void MandelbrotGUI::render_input_panel() {
     
     window.draw(render_button);
     window.draw(render_text);
+    window.draw(backends_text);
     window.draw(status_text);
     
     sf::RectangleShape controls_box;
-    controls_box.setSize(sf::Vector2f(640, 160));
+    controls_box.setSize(sf::Vector2f(640, 180));
     controls_box.setPosition(80, 520);
     controls_box.setFillColor(sf::Color(30, 35, 45));
     controls_box.setOutlineColor(sf::Color(70, 80, 90));
@@ -284,11 +298,12 @@ void MandelbrotGUI::render_input_panel() {
         "Mouse Hover: Real-time Julia set preview\n"
         "\n"
         "S Key: Save current view     J Key: Generate Julia set\n"
-        "R Key: Reset to original     ESC: Back to input panel"
+        "R Key: Reset to original     F Key: Next fractal formula\n"
+        "ESC: Back to input panel"
     );
     window.draw(controls_info);
     
-    status_text.setPosition(80, 700);
+    status_text.setPosition(80, 715);
 }
 
 void MandelbrotGUI::handle_input_panel_events(const sf::Event& event) {
@@ -333,16 +348,17 @@ void MandelbrotGUI::handle_input_panel_events(const sf::Event& event) {
             active_input = (active_input + 1) % 3;
         } else if (event.key.code == sf::Keyboard::Enter) {
             validate_and_start_render();
+        } else if (event.key.code == sf::Keyboard::S) {
+            toggle_backend(Backend::SERIAL);
+        } else if (event.key.code == sf::Keyboard::P) {
+            toggle_backend(Backend::PARALLEL);
+        } else if (event.key.code == sf::Keyboard::C) {
+            toggle_backend(Backend::CUDA);
         }
     }
 }
 
 void MandelbrotGUI::validate_and_start_render() {
-    if (!cuda_available) {
-        status_text.setString("CUDA not available!");
-        return;
-    }
-    
     if (!is_valid_input()) {
         status_text.setString("Invalid input! Max Resolution: " + std::to_string(MAX_RESOLUTION) + "x" + std::to_string(MAX_RESOLUTION) +
                               " Max Iterations: " + std::to_string(MAX_ITERATIONS));
@@ -371,12 +387,15 @@ bool MandelbrotGUI::is_valid_input() {
 }
 
 void MandelbrotGUI::start_rendering() {
-    cuda_result.completed = false;
-    cuda_result.render_time = 0.0;
-    cuda_result.image_data.clear();
+    finish_baseline(true);
+    
+    view_result.completed = false;
+    view_result.render_time = 0.0;
+    view_result.image_data.clear();
     
     if (generator) delete generator;
     generator = new MandelbrotGenerator(render_width, render_height, max_iterations);
+    generator->set_fractal(fractal_type);
     
     #ifdef USE_CUDA
     if (cuda_available) {
@@ -403,69 +422,203 @@ void MandelbrotGUI::start_rendering() {
 
 void MandelbrotGUI::print_benchmark_header() {
     std::cout << "\n=== PERFORMANCE BENCHMARK ===" << std::endl;
-    std::cout << "Testing Serial, Parallel, and CUDA implementations..." << std::endl;
+    std::cout << "Testing";
+    for (int b = 0; b < (int)Backend::BACKEND_COUNT; b++) {
+        if (selected_backends[b]) std::cout << " " << backend_name((Backend)b);
+    }
+    std::cout << " (serial baseline in the background)" << std::endl;
 }
 
+// Runs the interactive backends and keeps the fastest one's image for the view. The serial
+// baseline starts afterwards, off the critical path.
 void MandelbrotGUI::render_all_methods() {
-    // Serial CPU
-    std::cout << "\n1. Serial CPU Implementation:" << std::endl;
-    auto start = std::chrono::high_resolution_clock::now();
     generator->set_bounds(x_min, x_max, y_min, y_max);
-    std::vector<Color> serial_image(render_width * render_height);
-    generator->generate_serial(serial_image);
-    auto end = std::chrono::high_resolution_clock::now();
-    double serial_time = std::chrono::duration<double>(end - start).count();
-    std::cout << "   Time: " << std::fixed << std::setprecision(3) << serial_time << " seconds" << std::endl;
-    
-    // Parallel CPU
-    std::cout << "\n2. Parallel CPU Implementation:" << std::endl;
-    start = std::chrono::high_resolution_clock::now();
-    std::vector<Color> parallel_image(render_width * render_height);
-    generator->generate_parallel_threads(parallel_image);
-    end = std::chrono::high_resolution_clock::now();
-    double parallel_time = std::chrono::duration<double>(end - start).count();
-    std::cout << "   Time: " << std::fixed << std::setprecision(3) << parallel_time << " seconds" << std::endl;
-    std::cout << "   Speedup: " << std::fixed << std::setprecision(2) << serial_time / parallel_time << "x" << std::endl;
+    std::fill(method_times, method_times + (int)Backend::BACKEND_COUNT, 0.0);
+    bool use_cuda = cuda_available && selected_backends[(int)Backend::CUDA];
+    
+    // Parallel CPU, also whenever there is no CUDA result to show
+    if (selected_backends[(int)Backend::PARALLEL] || !use_cuda) {
+        std::cout << "\nParallel CPU Implementation:" << std::endl;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Color> parallel_image(render_width * render_height);
+        generator->generate_parallel_threads(parallel_image);
+        auto end = std::chrono::high_resolution_clock::now();
+        double parallel_time = std::chrono::duration<double>(end - start).count();
+        method_times[(int)Backend::PARALLEL] = parallel_time;
+        std::cout << "   Time: " << std::fixed << std::setprecision(3) << parallel_time << " seconds" << std::endl;
+        
+        view_method = RenderMethod::PARALLEL_CPU;
+        view_result.image_data = std::move(parallel_image);
+        view_result.render_time = parallel_time;
+        view_result.method_name = "Parallel CPU";
+        view_result.completed = true;
+    }
     
     // CUDA GPU
     #ifdef USE_CUDA
-    if (cuda_available) {
-        std::cout << "\n3. CUDA GPU Implementation:" << std::endl;
-        start = std::chrono::high_resolution_clock::now();
-        cuda_result.image_data.resize(render_width * render_height);
-        generator->generate_cuda(cuda_result.image_data);
-        end = std::chrono::high_resolution_clock::now();
-        cuda_result.render_time = std::chrono::duration<double>(end - start).count();
-        cuda_result.completed = true;
-        
-        std::cout << "   Time: " << std::fixed << std::setprecision(3) << cuda_result.render_time << " seconds" << std::endl;
-        std::cout << "   Speedup vs Serial: " << std::fixed << std::setprecision(2) << serial_time / cuda_result.render_time << "x" << std::endl;
-        std::cout << "   Speedup vs Parallel: " << std::fixed << std::setprecision(2) << parallel_time / cuda_result.render_time << "x" << std::endl;
-        
-        // Performance summary
-        std::cout << "\n=== PERFORMANCE SUMMARY ===" << std::endl;
-        std::cout << "┌─────────────────────┬─────────────┬─────────────┬─────────────────┐" << std::endl;
-        std::cout << "│ Method              │ Time (s)    │ Speedup     │ Throughput      │" << std::endl;
-        std::cout << "├─────────────────────┼─────────────┼─────────────┼─────────────────┤" << std::endl;
-        
-        double pixels_per_second_serial = (render_width * render_height) / serial_time;
-        std::cout << "│ Serial CPU          │ " << std::setw(11) << std::fixed << std::setprecision(3) << serial_time 
-                  << " │ " << std::setw(11) << "1.00x" << " │ " << std::setw(11) << std::scientific << std::setprecision(2) 
-                  << pixels_per_second_serial << " px/s │" << std::endl;
+    if (use_cuda) {
+        std::cout << "\nCUDA GPU Implementation:" << std::endl;
+        auto start = std::chrono::high_resolution_clock::now();
+        std::vector<Color> cuda_image(render_width * render_height);
+        generator->generate_cuda(cuda_image);
+        auto end = std::chrono::high_resolution_clock::now();
+        double cuda_time = std::chrono::duration<double>(end - start).count();
+        method_times[(int)Backend::CUDA] = cuda_time;
+        std::cout << "   Time: " << std::fixed << std::setprecision(3) << cuda_time << " seconds" << std::endl;
         
-        double pixels_per_second_parallel = (render_width * render_height) / parallel_time;
-        std::cout << "│ Parallel CPU        │ " << std::setw(11) << std::fixed << std::setprecision(3) << parallel_time 
-                  << " │ " << std::setw(11) << std::fixed << std::setprecision(2) << serial_time / parallel_time << "x" 
-                  << " │ " << std::setw(11) << std::scientific << std::setprecision(2) << pixels_per_second_parallel << " px/s │" << std::endl;
+        if (!view_result.completed || cuda_time < view_result.render_time) {
+            view_method = RenderMethod::CUDA;
+            view_result.image_data = std::move(cuda_image);
+            view_result.render_time = cuda_time;
+            view_result.method_name = "CUDA GPU";
+            view_result.completed = true;
+        }
+    }
+    #endif
+    
+    std::cout << "\nInteractive backend: " << view_result.method_name << " (fastest at " << render_width << "x" << render_height << ")" << std::endl;
+    
+    if (selected_backends[(int)Backend::SERIAL]) {
+        start_baseline();
+    } else {
+        print_benchmark_summary();
+    }
+}
+
+void MandelbrotGUI::print_benchmark_summary() {
+    double serial_time = method_times[(int)Backend::SERIAL];
+    const char* labels[] = { "Serial CPU          ", "Parallel CPU        ", "CUDA GPU            " };
+    
+    std::cout << "\n=== PERFORMANCE SUMMARY ===" << std::endl;
+    std::cout << "┌─────────────────────┬─────────────┬─────────────┬─────────────────┐" << std::endl;
+    std::cout << "│ Method              │ Time (s)    │ Speedup     │ Throughput      │" << std::endl;
+    std::cout << "├─────────────────────┼─────────────┼─────────────┼─────────────────┤" << std::endl;
+    
+    for (int b = 0; b < (int)Backend::BACKEND_COUNT; b++) {
+        if (method_times[b] <= 0.0) continue;
         
-        double pixels_per_second_cuda = (render_width * render_height) / cuda_result.render_time;
-        std::cout << "│ CUDA GPU            │ " << std::setw(11) << std::fixed << std::setprecision(3) << cuda_result.render_time 
-                  << " │ " << std::setw(11) << std::fixed << std::setprecision(2) << serial_time / cuda_result.render_time << "x" 
-                  << " │ " << std::setw(11) << std::scientific << std::setprecision(2) << pixels_per_second_cuda << " px/s │" << std::endl;
+        std::stringstream speedup;
+        if (serial_time > 0.0) {
+            speedup << std::fixed << std::setprecision(2) << serial_time / method_times[b] << "x";
+        } else {
+            speedup << "-";
+        }
         
-        std::cout << "└─────────────────────┴─────────────┴─────────────┴─────────────────┘" << std::endl;
+        double pixels_per_second = (render_width * render_height) / method_times[b];
+        std::cout << "│ " << labels[b] << "│ " << std::setw(11) << std::fixed << std::setprecision(3) << method_times[b] 
+                  << " │ " << std::setw(11) << speedup.str() << " │ " << std::setw(11) << std::scientific << std::setprecision(2) 
+                  << pixels_per_second << " px/s │" << std::endl;
+    }
+    
+    std::cout << "└─────────────────────┴─────────────┴─────────────┴─────────────────┘" << std::endl;
+}
+
+// Serial baseline of the first view: from the cache when this scene was measured before,
+// otherwise on a background thread with a copy of the generator, so the window stays usable
+void MandelbrotGUI::start_baseline() {
+    baseline_scene = generator->scene_key();
+    if (baseline_cache.lookup(baseline_scene, Backend::SERIAL, method_times[(int)Backend::SERIAL])) {
+        std::cout << "\nSerial CPU baseline: " << std::fixed << std::setprecision(3)
+                  << method_times[(int)Backend::SERIAL] << " seconds (cached)" << std::endl;
+        print_benchmark_summary();
+        return;
+    }
+    
+    std::cout << "\nSerial CPU baseline: running in the background..." << std::endl;
+    baseline_done = false;
+    baseline_cancel = false;
+    baseline_running = true;
+    baseline_contended = false;
+    
+    MandelbrotGenerator baseline_generator = *generator;
+    baseline_generator.set_cancel_flag(&baseline_cancel);
+    int pixels = render_width * render_height;
+    baseline_thread = std::thread([this, baseline_generator, pixels]() mutable {
+        std::vector<Color> image(pixels);
+        double time = benchmark_function([&]() {
+            baseline_generator.generate_serial(image);
+        });
+        // A cancelled render stopped early, its time means nothing
+        if (!baseline_cancel) method_times[(int)Backend::SERIAL] = time;
+        baseline_done = true;
+    });
+}
+
+// Collects the background baseline once it has finished. cancel stops it instead (the render
+// ends within a row) and discards it unless it had already completed.
+void MandelbrotGUI::finish_baseline(bool cancel) {
+    if (!baseline_running || (!cancel && !baseline_done)) return;
+    
+    if (cancel) baseline_cancel = true;
+    baseline_thread.join();
+    baseline_running = false;
+    
+    double serial_time = method_times[(int)Backend::SERIAL];
+    if (serial_time <= 0.0) {
+        std::cout << "\nSerial CPU baseline: cancelled" << std::endl;
+        return;
+    }
+    
+    std::cout << "\nSerial CPU baseline: " << std::fixed << std::setprecision(3) << serial_time << " seconds";
+    if (baseline_contended) {
+        // Zoom / pan / Julia renders took CPU time from it: report, but keep it out of the cache
+        std::cout << " (shared the CPU with interactive renders, not cached)";
+    } else {
+        baseline_cache.store(baseline_scene, Backend::SERIAL, serial_time);
+    }
+    std::cout << std::endl;
+    print_benchmark_summary();
+}
+
+// The interactive view needs the parallel CPU engine or CUDA, so the last of the two stays on
+void MandelbrotGUI::toggle_backend(Backend backend) {
+    if (backend == Backend::CUDA && !cuda_available) {
+        status_text.setString("CUDA not available");
+        return;
+    }
+    
+    selected_backends[(int)backend] = !selected_backends[(int)backend];
+    bool interactive = selected_backends[(int)Backend::PARALLEL] ||
+                       (cuda_available && selected_backends[(int)Backend::CUDA]);
+    if (!interactive) {
+        selected_backends[(int)backend] = true;
+        status_text.setString("Parallel CPU or CUDA is needed for the interactive view");
+    }
+    
+    update_backends_text();
+}
+
+void MandelbrotGUI::update_backends_text() {
+    auto mark = [&](Backend backend) {
+        if (backend == Backend::CUDA && !cuda_available) return "[-] ";
+        return selected_backends[(int)backend] ? "[x] " : "[ ] ";
+    };
+    
+    backends_text.setString(std::string("Backends:  ") + mark(Backend::SERIAL) + "Serial (S)   " +
+                            mark(Backend::PARALLEL) + "Parallel (P)   " + mark(Backend::CUDA) + "CUDA (C)");
+}
+
+// Renders the current bounds with the interactive backend
+void MandelbrotGUI::render_view(std::vector<Color>& image) {
+    baseline_contended = baseline_contended || (baseline_running && !baseline_done);
+    #ifdef USE_CUDA
+    if (view_method == RenderMethod::CUDA) {
+        generator->generate_cuda(image);
+        return;
+    }
+    #endif
+    generator->generate_parallel_threads(image);
+}
+
+void MandelbrotGUI::render_julia(std::vector<Color>& image, std::complex<double> c) {
+    baseline_contended = baseline_contended || (baseline_running && !baseline_done);
+    #ifdef USE_CUDA
+    if (view_method == RenderMethod::CUDA) {
+        generator->generate_julia_cuda(image, c);
+        return;
     }
     #endif
+    generator->generate_julia_parallel(image, c);
 }
 
 void MandelbrotGUI::finish_rendering() {
@@ -474,7 +627,7 @@ void MandelbrotGUI::finish_rendering() {
     
     std::cout << "\n=== RENDERING COMPLETE ===" << std::endl;
     std::cout << "Window switched to Mandelbrot view" << std::endl;
-    std::cout << "Controls: +/- or Mouse wheel=Zoom (1.0x-1000x), Left-drag=Area zoom, Right-drag=Pan, S=Save, J=Julia, R=Reset, ESC=Back" << std::endl;
+    std::cout << "Controls: +/- or Mouse wheel=Zoom (1.0x-1000x), Left-drag=Area zoom, Right-drag=Pan, S=Save, J=Julia, R=Reset, F=Fractal, ESC=Back" << std::endl;
 }
 
 void MandelbrotGUI::setup_results_view() {
@@ -482,8 +635,8 @@ void MandelbrotGUI::setup_results_view() {
                  "Mandelbrot " + std::to_string(render_width) + "x" + std::to_string(render_height));
     window.setFramerateLimit(60);
     
-    if (cuda_result.completed) {
-        convert_to_texture(cuda_result.image_data, result_texture);
+    if (view_result.completed) {
+        convert_to_texture(view_result.image_data, result_texture);
         result_sprite.setTexture(result_texture);
         result_sprite.setPosition(0, 0);
     }
@@ -525,11 +678,12 @@ void MandelbrotGUI::setup_minimap() {
     minimap_data.resize(minimap_size * minimap_size);
 
     std::complex<double> default_julia(-0.7, 0.27015);
+    hover_julia_constant = default_julia;
     generate_mini_julia_preview(default_julia);
 }
 
 void MandelbrotGUI::render_results_view() {
-    if (cuda_result.completed) {
+    if (view_result.completed) {
         window.setView(image_view);
         window.draw(result_sprite);
 
@@ -605,6 +759,9 @@ void MandelbrotGUI::handle_results_view_events(const sf::Event& event) {
         } else if (event.key.code == sf::Keyboard::R) {
             reset_view();
             return;
+        } else if (event.key.code == sf::Keyboard::F) {
+            cycle_fractal();
+            return;
         } else if (event.key.code == sf::Keyboard::Equal || event.key.code == sf::Keyboard::Add) {
             perform_zoom(1.1f);
             return;
@@ -637,7 +794,7 @@ void MandelbrotGUI::handle_results_view_events(const sf::Event& event) {
 }
 
 void MandelbrotGUI::handle_zoom_pan_events(const sf::Event& event) {
-    if (!cuda_result.completed) return;
+    if (!view_result.completed) return;
     
     if (event.type == sf::Event::MouseButtonPressed) {
         if (event.mouseButton.button == sf::Mouse::Left) {
@@ -691,7 +848,7 @@ void MandelbrotGUI::handle_mouse_wheel(float delta) {
 }
 
 void MandelbrotGUI::perform_zoom(float factor) {
-    if (!cuda_result.completed) return;
+    if (!view_result.completed) return;
     
     float new_zoom_factor = zoom_factor * factor;
     
@@ -907,25 +1064,28 @@ void MandelbrotGUI::update_fractal_bounds() {
 }
 
 void MandelbrotGUI::real_time_rerender() {
-    if (!generator || !cuda_available || !cuda_result.completed || !is_zoom_changed) return;
+    if (!generator || !view_result.completed || !is_zoom_changed) return;
     
-    std::cout << "[RERENDER] Real-time CUDA recalculation..." << std::endl;
+    std::cout << "[RERENDER] Real-time " << view_result.method_name << " recalculation..." << std::endl;
     std::cout << "[RERENDER] Zoom factor: " << zoom_factor << "x" << std::endl;
     std::cout << "[RERENDER] Bounds: x[" << std::fixed << std::setprecision(6) << x_min << ", " << x_max << "] y[" << y_min << ", " << y_max << "]" << std::endl;
     
     generator->set_bounds(x_min, x_max, y_min, y_max);
+    // AUTO precision escalates float -> double -> double-double as the view narrows
+    std::cout << "[RERENDER] Precision: " << precision_name(generator->render_precision(view_method == RenderMethod::CUDA))
+              << std::endl;
 
     auto start = std::chrono::high_resolution_clock::now();
-    generator->generate_cuda(cuda_result.image_data);
+    render_view(view_result.image_data);
     auto end = std::chrono::high_resolution_clock::now();
     
-    convert_to_texture(cuda_result.image_data, result_texture);
+    convert_to_texture(view_result.image_data, result_texture);
     result_sprite.setTexture(result_texture);
     
     double render_time = std::chrono::duration<double>(end - start).count();
-    cuda_result.render_time = render_time;
+    view_result.render_time = render_time;
 
-    std::cout << "[RERENDER] CUDA recalculation complete: " << std::fixed << std::setprecision(3) 
+    std::cout << "[RERENDER] " << view_result.method_name << " recalculation complete: " << std::fixed << std::setprecision(3) 
               << render_time << "s (zoom: " << std::setprecision(2) << zoom_factor << "x)" << std::endl;
     
     is_zoom_changed = false;
@@ -945,6 +1105,7 @@ void MandelbrotGUI::update_julia_preview(sf::Vector2i mouse_pos) {
        << preview_constant.real() << " + " << preview_constant.imag() << "i";
     minimap_coords.setString(ss.str());
 
+    hover_julia_constant = preview_constant;
     generate_mini_julia_preview(preview_constant);
 }
 
@@ -959,38 +1120,36 @@ void MandelbrotGUI::generate_mini_julia_preview(std::complex<double> c) {
     int preview_iterations = std::min(100, max_iterations);
     double color_scale = (double)max_iterations / preview_iterations;
     
-    for (int y = 0; y < minimap_size; y++) {
-        for (int x = 0; x < minimap_size; x++) {
-            double real = julia_x_min + (julia_x_max - julia_x_min) * x / (minimap_size - 1);
-            double imag = julia_y_min + (julia_y_max - julia_y_min) * y / (minimap_size - 1);
-            
-            std::complex<double> z(real, imag);
-            int iterations = 0;
-
-            while (std::abs(z) <= 2.0 && iterations < preview_iterations) {
-                z = z * z + c;
-                iterations++;
-            }
-
-            if (iterations == preview_iterations) {
-                iterations = max_iterations;
-            } else {
-                iterations = (int)(iterations * color_scale);
-            }
-
-            Color color;
-            if (iterations == max_iterations) {
-                color = Color(0, 0, 0);
-            } else {
-                double t = (double)iterations / max_iterations;
-                color.r = (unsigned char)(9 * (1 - t) * t * t * t * 255);
-                color.g = (unsigned char)(15 * (1 - t) * (1 - t) * t * t * 255);
-                color.b = (unsigned char)(8.5 * (1 - t) * (1 - t) * (1 - t) * t * 255);
+    with_formula(fractal_type, [&](auto formula) {
+        using F = decltype(formula);
+        
+        for (int y = 0; y < minimap_size; y++) {
+            for (int x = 0; x < minimap_size; x++) {
+                double real = julia_x_min + (julia_x_max - julia_x_min) * x / (minimap_size - 1);
+                double imag = julia_y_min + (julia_y_max - julia_y_min) * y / (minimap_size - 1);
+                
+                int iterations = escape_iterations<F, true>(real, imag, c.real(), c.imag(), preview_iterations);
+
+                if (iterations == preview_iterations) {
+                    iterations = max_iterations;
+                } else {
+                    iterations = (int)(iterations * color_scale);
+                }
+
+                Color color;
+                if (iterations == max_iterations) {
+                    color = Color(0, 0, 0);
+                } else {
+                    double t = (double)iterations / max_iterations;
+                    color.r = (unsigned char)(9 * (1 - t) * t * t * t * 255);
+                    color.g = (unsigned char)(15 * (1 - t) * (1 - t) * t * t * 255);
+                    color.b = (unsigned char)(8.5 * (1 - t) * (1 - t) * (1 - t) * t * 255);
+                }
+                
+                minimap_data[y * minimap_size + x] = color;
             }
-            
-            minimap_data[y * minimap_size + x] = color;
         }
-    }
+    });
 
     std::vector<sf::Uint8> pixel_data;
     pixel_data.resize(minimap_data.size() * 4);
@@ -1040,15 +1199,7 @@ void MandelbrotGUI::generate_julia_set() {
     
     auto start = std::chrono::high_resolution_clock::now();
     
-    #ifdef USE_CUDA
-    if (cuda_available) {
-        generator->generate_julia_cuda(julia_image_data, julia_constant);
-    } else {
-        generator->generate_julia_serial(julia_image_data, julia_constant);
-    }
-    #else
-    generator->generate_julia_serial(julia_image_data, julia_constant);
-    #endif
+    render_julia(julia_image_data, julia_constant);
     
     auto end = std::chrono::high_resolution_clock::now();
     double render_time = std::chrono::duration<double>(end - start).count();
@@ -1082,15 +1233,25 @@ void MandelbrotGUI::generate_julia_set() {
     std::cout << "Preview constant matches saved constant exactly!" << std::endl;
 }
 
+void MandelbrotGUI::cycle_fractal() {
+    fractal_type = (FractalType)(((int)fractal_type + 1) % (int)FractalType::FRACTAL_COUNT);
+    if (generator) generator->set_fractal(fractal_type);
+    
+    std::cout << "[FRACTAL] " << fractal_name(fractal_type) << std::endl;
+    
+    generate_mini_julia_preview(hover_julia_constant);
+    is_zoom_changed = true;
+}
+
 void MandelbrotGUI::save_current_view() {
-    if (!cuda_result.completed) return;
+    if (!view_result.completed) return;
     
     std::string filename = "../output/mandelbrot_" + 
                           std::to_string(render_width) + "x" + std::to_string(render_height) + 
                           "_zoom" + std::to_string((int)zoom_factor) + "x_" +
                           get_timestamp() + ".bmp";
     
-    generator->save_bmp(cuda_result.image_data, filename);
+    generator->save_bmp(view_result.image_data, filename);
     
     std::cout << "Current view saved: " << filename << std::endl;
 }
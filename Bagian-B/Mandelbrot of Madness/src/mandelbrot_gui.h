@@ -6,6 +6,8 @@
 #include <vector>
 #include <string>
 #include <array>
+#include <thread>
+#include <atomic>
 
 enum class ViewMode {
     INPUT_PANEL,
@@ -13,7 +15,8 @@ enum class ViewMode {
 };
 
 enum class RenderMethod {
-    CUDA = 0
+    CUDA = 0,
+    PARALLEL_CPU
 };
 
 struct RenderResult {
@@ -73,7 +76,10 @@ private:
     
     // Rendering
     MandelbrotGenerator* generator;
-    RenderResult cuda_result;
+    RenderResult view_result;
+    // Backend of the interactive view: the faster of CUDA and the parallel CPU engine in the
+    // startup benchmark, the CPU engine when there is no GPU
+    RenderMethod view_method;
     bool rendering_in_progress;
     
     // Status
@@ -104,6 +110,23 @@ private:
     bool cuda_available;
     bool font_loaded;
     
+    // Formula shared by the main view, the Julia preview and saved Julia sets
+    FractalType fractal_type;
+    
+    // Backends of the benchmark run, indexed by Backend. The serial baseline runs on a background
+    // thread once the interactive view is up, or comes from the per-scene cache. A new render or
+    // closing the window cancels it; one that shared the CPU with interactive renders is not cached.
+    std::vector<bool> selected_backends;
+    sf::Text backends_text;
+    double method_times[(int)Backend::BACKEND_COUNT];    // seconds, 0 = not run
+    BaselineCache baseline_cache;
+    std::thread baseline_thread;
+    std::atomic<bool> baseline_done;
+    std::atomic<bool> baseline_cancel;
+    bool baseline_running;
+    bool baseline_contended;
+    std::string baseline_scene;
+    
     // Constants
     static const int MAX_RESOLUTION = 2000;
     static const int MAX_ITERATIONS = 10000;
@@ -150,6 +173,11 @@ private:
     // Benchmark methods
     void print_benchmark_header();
     void render_all_methods();
+    void print_benchmark_summary();
+    void start_baseline();
+    void finish_baseline(bool cancel);
+    void toggle_backend(Backend backend);
+    void update_backends_text();
     
     // Coordinate mapping
     bool is_mouse_over_image(sf::Vector2i mouse_pos);
@@ -159,6 +187,8 @@ private:
     void start_rendering();
     void finish_rendering();
     void real_time_rerender();
+    void render_view(std::vector<Color>& image);
+    void render_julia(std::vector<Color>& image, std::complex<double> c);
     
     // Image handling
     void convert_to_texture(const std::vector<Color>& image_data, sf::Texture& texture);
@@ -180,6 +210,7 @@ private:
     // Julia set functionality
     void update_julia_constant_from_mouse(sf::Vector2i mouse_pos);
     void generate_julia_set();
+    void cycle_fractal();
     
     // UI helpers  
     bool is_point_in_rect(int x, int y, const sf::RectangleShape& rect);
@@ -0,0 +1,291 @@
+/*
+ * File      : bench.c
+ * Author    : Nayekah
+ * Date      : 2025-08-01
+ * Modified  : Native benchmark for libbigmul: operands generated in-process, per-phase medians,
+ *             table / CSV / JSON output.
+ *             -v: verification overhead.
+ *
+ * ./bench [-s 1e3,1e4,...] [-r reps] [-t threads] [-f table|csv|json] [-q] [-v checks]
+ *   -s  operand sizes in digits (both operands), default 1e3 .. 1e7 by decades
+ *   -r  timed runs per size after one warm-up run, default 5
+ *   -t  team size, default BIGMUL_THREADS or every online CPU
+ *   -f  output format, default table
+ *   -q  square (a * a) instead of a * b
+ *   -v  verify every NTT product modulo this many random primes, default 0
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "bigmul.h"
+
+// MACROS AND CONSTANTS
+#define MAX_SIZES 64
+#define MAX_REPS 101
+// parse, forward, pointwise, inverse, carry, small, format, verify, total
+#define FIELDS 9
+#define TOTAL 8
+#define NS_PER_SECOND 1000000000ULL
+
+#define IS_EQUAL(a, b) (!((a) ^ (b)))
+#define IS_NOT_ZERO(a) (!!(a))
+
+typedef unsigned long long ull;
+
+size_t subtract(size_t a, size_t b) { size_t borrow; sub_loop: if (!!b) { borrow = (~a) & b; a = a ^ b; b = borrow << 1; goto sub_loop; } return a; }
+static inline ull fast_add(ull a, ull b) { ull res; __builtin_add_overflow(a, b, &res); return res; }
+static inline ull fast_sub(ull a, ull b) { ull res; __builtin_sub_overflow(a, b, &res); return res; }
+static inline ull fast_mul(ull a, ull b) { ull res; __builtin_mul_overflow(a, b, &res); return res; }
+static inline ull mul_hi(ull a, ull b) { unsigned __int128 res; __builtin_mul_overflow((unsigned __int128)a, b, &res); return res >> 64; }
+
+static const char* field_names[FIELDS] = { "parse", "forward", "pointwise", "inverse", "carry", "small", "format", "verify", "total" };
+
+typedef struct {
+    size_t digits;
+    int status;
+    ull median[FIELDS];           // nanoseconds
+} bench_row;
+
+static ull clock_ns(void) { struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t); return fast_add(fast_mul((ull)t.tv_sec, NS_PER_SECOND), (ull)t.tv_nsec); }
+
+// xorshift64, plenty for benchmark digits
+static ull rng_state = 0x9E3779B97F4A7C15ULL;
+static ull rng_next(void) {
+    rng_state ^= rng_state << 13;
+    rng_state ^= rng_state >> 7;
+    rng_state ^= rng_state << 17;
+    return rng_state;
+}
+// Uniform in [0, n): the high word of rng * n
+static ull rng_below(ull n) { return mul_hi(rng_next(), n); }
+
+// len random digits, the leading one nonzero
+static char* random_digits(size_t len) {
+    char* s = malloc(len);
+    size_t i = 1;
+    if (!s) { return NULL; }
+    s[0] = (char)fast_add('1', rng_below(9));
+fill_loop:
+    if (IS_NOT_ZERO(subtract(len, i))) {
+        s[i] = (char)fast_add('0', rng_below(10));
+        i = -~i;
+        goto fill_loop;
+    }
+    return s;
+}
+
+static int compare_ull(const void* a, const void* b) {
+    ull x = *(const ull*)a, y = *(const ull*)b;
+    return IS_EQUAL(x, y) ? 0 : (x > y ? 1 : -1);
+}
+
+static ull median(ull* samples, int count) {
+    qsort(samples, count, sizeof(ull), compare_ull);
+    if (count & 1) { return samples[count >> 1]; }
+    return fast_add(samples[subtract(count >> 1, 1)], samples[count >> 1]) >> 1;
+}
+
+// "1e3,2500,1e6" into sizes[], returns how many
+static int parse_sizes(const char* list, size_t sizes[]) {
+    int count = 0;
+    char* end;
+parse_loop:
+    if (IS_NOT_ZERO(*list) && IS_NOT_ZERO(subtract(count, MAX_SIZES))) {
+        double value = strtod(list, &end);
+        if (end == list || !(value >= 1)) { return -1; }
+        sizes[count] = (size_t)value;
+        count = -~count;
+        list = end;
+        if (IS_EQUAL(*list, ',')) { list = &list[1]; }
+        goto parse_loop;
+    }
+    return count;
+}
+
+// One size: a warm-up product (tables, scratch, pages), then reps timed ones
+static void bench_size(bigmul_ctx* ctx, size_t digits, int reps, int square, bench_row* row) {
+    ull samples[FIELDS][MAX_REPS];
+    bigmul_stats stats;
+    size_t out_len;
+    char* a = random_digits(digits);
+    char* b = square ? a : random_digits(digits);
+    char* out = malloc(bigmul_out_size(digits, digits));
+    int r = 0, f;
+
+    row->digits = digits;
+    row->status = BIGMUL_ERR_NOMEM;
+    if (!a || !b || !out) { goto done; }
+    bigmul_set_stats(ctx, NULL);
+    row->status = bigmul(ctx, a, digits, b, digits, out, &out_len);
+    bigmul_set_stats(ctx, &stats);
+rep_loop:
+    if (IS_EQUAL(row->status, BIGMUL_OK) && IS_NOT_ZERO(subtract(r, reps))) {
+        memset(&stats, 0, sizeof(stats));
+        ull start = clock_ns();
+        row->status = bigmul(ctx, a, digits, b, digits, out, &out_len);
+        samples[TOTAL][r] = fast_sub(clock_ns(), start);
+        samples[0][r] = stats.parse;
+        samples[1][r] = stats.forward;
+        samples[2][r] = stats.pointwise;
+        samples[3][r] = stats.inverse;
+        samples[4][r] = stats.carry;
+        samples[5][r] = stats.small;
+        samples[6][r] = stats.format;
+        samples[7][r] = stats.verify;
+        r = -~r;
+        goto rep_loop;
+    }
+    bigmul_set_stats(ctx, NULL);
+    if (IS_EQUAL(row->status, BIGMUL_OK)) {
+        f = 0;
+    median_loop:
+        if (IS_NOT_ZERO(subtract(f, FIELDS))) {
+            row->median[f] = median(samples[f], reps);
+            f = -~f;
+            goto median_loop;
+        }
+    }
+done:
+    if (b != a) { free(b); }
+    free(a);
+    free(out);
+}
+
+// Throughput counts the digits of both operands
+static ull digits_per_second(const bench_row* row) {
+    if (!IS_NOT_ZERO(row->median[TOTAL])) { return 0; }
+    return lldiv(fast_mul(row->digits << 1, NS_PER_SECOND), row->median[TOTAL]).quot;
+}
+
+// value / unit with `places` decimals, the remainder cut down by frac_unit
+static void print_fixed(ull value, long long unit, long long frac_unit, int width, int places) {
+    lldiv_t whole = lldiv(value, unit);
+    printf("%*lld.%0*lld", width, whole.quot, places, lldiv(whole.rem, frac_unit).quot);
+}
+
+static void print_table(const bench_row rows[], int count) {
+    int i = 0, f;
+    printf("%10s", "digits");
+    f = 0;
+header_loop:
+    if (IS_NOT_ZERO(subtract(f, FIELDS))) { printf(" %10s", field_names[f]); f = -~f; goto header_loop; }
+    printf(" %12s\n", "Mdigits/s");
+row_loop:
+    if (IS_NOT_ZERO(subtract(i, count))) {
+        printf("%10zu", rows[i].digits);
+        f = 0;
+    field_loop:
+        if (IS_NOT_ZERO(subtract(f, FIELDS))) { putchar(' '); print_fixed(rows[i].median[f], 1000000, 1000, 6, 3); f = -~f; goto field_loop; }
+        putchar(' ');
+        print_fixed(digits_per_second(&rows[i]), 1000000, 10000, 9, 2);
+        putchar('\n');
+        i = -~i;
+        goto row_loop;
+    }
+    printf("(phase medians in ms)\n");
+}
+
+static void print_csv(const bench_row rows[], int count, int threads, int reps) {
+    int i = 0, f;
+    printf("digits,threads,reps");
+    f = 0;
+header_loop:
+    if (IS_NOT_ZERO(subtract(f, FIELDS))) { printf(",%s_s", field_names[f]); f = -~f; goto header_loop; }
+    printf(",digits_per_s\n");
+row_loop:
+    if (IS_NOT_ZERO(subtract(i, count))) {
+        printf("%zu,%d,%d", rows[i].digits, threads, reps);
+        f = 0;
+    field_loop:
+        if (IS_NOT_ZERO(subtract(f, FIELDS))) { putchar(','); print_fixed(rows[i].median[f], NS_PER_SECOND, 1, 0, 9); f = -~f; goto field_loop; }
+        printf(",%llu\n", digits_per_second(&rows[i]));
+        i = -~i;
+        goto row_loop;
+    }
+}
+
+static void print_json(const bench_row rows[], int count, int threads, int reps, int square, int checks) {
+    int i = 0, f;
+    printf("{\"threads\": %d, \"reps\": %d, \"square\": %s, \"verify\": %d, \"results\": [", threads, reps,
+           square ? "true" : "false", checks);
+row_loop:
+    if (IS_NOT_ZERO(subtract(i, count))) {
+        printf("%s\n  {\"digits\": %zu", IS_EQUAL(i, 0) ? "" : ",", rows[i].digits);
+        f = 0;
+    field_loop:
+        if (IS_NOT_ZERO(subtract(f, FIELDS))) { printf(", \"%s_s\": ", field_names[f]); print_fixed(rows[i].median[f], NS_PER_SECOND, 1, 0, 9); f = -~f; goto field_loop; }
+        printf(", \"digits_per_s\": %llu}", digits_per_second(&rows[i]));
+        i = -~i;
+        goto row_loop;
+    }
+    printf("\n]}\n");
+}
+
+int main(int argc, char* argv[]) {
+    static bench_row rows[MAX_SIZES];
+    size_t sizes[MAX_SIZES] = { 1000, 10000, 100000, 1000000, 10000000 };
+    int size_count = 5, reps = 5, threads = 0, square = 0, checks = 0, done = 0, i = 0, opt;
+    const char* format = "table";
+    const char* env = getenv("BIGMUL_THREADS");
+    if (env) { threads = atoi(env); }
+
+option_loop:
+    opt = getopt(argc, argv, "s:r:t:f:qv:h");
+    if (!IS_EQUAL(opt, -1)) {
+        if (IS_EQUAL(opt, 's')) {
+            size_count = parse_sizes(optarg, sizes);
+        } else if (IS_EQUAL(opt, 'r')) {
+            reps = atoi(optarg);
+        } else if (IS_EQUAL(opt, 't')) {
+            threads = atoi(optarg);
+        } else if (IS_EQUAL(opt, 'f')) {
+            format = optarg;
+        } else if (IS_EQUAL(opt, 'q')) {
+            square = 1;
+        } else if (IS_EQUAL(opt, 'v')) {
+            checks = atoi(optarg);
+        } else {
+            size_count = -1;
+        }
+        goto option_loop;
+    }
+    if (!(size_count > 0) || !(reps > 0) || reps > MAX_REPS ||
+        (strcmp(format, "table") && strcmp(format, "csv") && strcmp(format, "json"))) {
+        fprintf(stderr, "Usage: %s [-s 1e3,1e4,...] [-r reps (1-%d)] [-t threads] [-f table|csv|json] [-q] [-v checks]\n", argv[0], MAX_REPS);
+        return 1;
+    }
+
+    bigmul_ctx* ctx = bigmul_create(0);
+    if (!ctx) { fprintf(stderr, "Error: Cannot create a context\n"); return 1; }
+    threads = bigmul_set_threads(ctx, threads);
+    checks = bigmul_set_verify(ctx, checks);
+
+size_loop:
+    if (IS_NOT_ZERO(subtract(i, size_count))) {
+        bench_size(ctx, sizes[i], reps, square, &rows[done]);
+        if (IS_EQUAL(rows[done].status, BIGMUL_OK)) {
+            done = -~done;
+        } else {
+            // BIGMUL_ERR_SIZE past the largest transform (~16.7M digits per operand)
+            fprintf(stderr, "Skipped %zu digits: status %d\n", sizes[i], rows[done].status);
+        }
+        i = -~i;
+        goto size_loop;
+    }
+    bigmul_destroy(ctx);
+
+    if (IS_EQUAL(strcmp(format, "csv"), 0)) {
+        print_csv(rows, done, threads, reps);
+    } else if (IS_EQUAL(strcmp(format, "json"), 0)) {
+        print_json(rows, done, threads, reps, square, checks);
+    } else {
+        print_table(rows, done);
+    }
+    return 0;
+}
@@ -48,14 +48,13 @@ def run(a, b):
     print(f"Saved a and b to output/a.txt and output/b.txt")
     
     print("\nRunning multiplication program...")
-    input_data = f"{a}\n{b}\n"
-    
+
     try:
         start_time = time.time()
 
+        # File mode: multiply maps the operands itself and writes the product straight to disk
         result = subprocess.run(
-            ['./multiply'],
-            input=input_data,
+            ['./multiply', 'output/a.txt', 'output/b.txt', 'output/result.txt'],
             text=True,
             capture_output=True
         )
@@ -63,19 +62,13 @@ def run(a, b):
         end_time = time.time()
         
         if result.returncode == 0:
-            lines = result.stdout.strip().split('\n')
-            for line in lines:
-                if line.startswith("Result: "):
-                    result_number = line.replace("Result: ", "").strip()
-                    
-                    with open('output/result.txt', 'w') as f:
-                        f.write(result_number)
-                    
-                    print(f"Program Success!")
-                    print(f"Time: {end_time - start_time:.2f} seconds")
-                    print(f"Result: {len(result_number)} digits")
-                    print(f"Saved to: output/result.txt")
-                    return True
+            result_digits = os.path.getsize('output/result.txt')
+
+            print(f"Program Success!")
+            print(f"Time: {end_time - start_time:.2f} seconds")
+            print(f"Result: {result_digits} digits")
+            print(f"Saved to: output/result.txt")
+            return True
         
         print(f"Program failed: {result.stderr}")
         return False
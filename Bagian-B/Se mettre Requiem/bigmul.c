@@ -0,0 +1,1830 @@
+/*
+ * File      : bigmul.c
+ * Author    : Nayekah
+ * Date      : 2025-08-01
+ * Modified  : Split out of multiply.c as a reusable library (libbigmul).
+ *             Convolution runs under two NTT primes and is recombined with CRT,
+ *             a single 998244353 overflowed once operands passed ~10 limbs.
+ *             SWAR parsing (8 digits per step) and table-driven formatting.
+ *             Carry normalization by multiply-high, in blocks with a prefix-carry fixup.
+ *             Squares take a single forward transform per prime.
+ *             Worker pool per context: transforms, pointwise products and carry blocks run on a team.
+ *             DIF forward / DIT inverse without bit reversal, blocked narrow stages, radix-4 wide passes.
+ *             Schoolbook / Karatsuba / Toom-3 below the NTT threshold, lopsided operands chunked.
+ *             Transform lengths 2^k or 3 * 2^k (radix-3 pass), primes changed to allow it.
+ *             Prepared operands: a fixed factor's forward transform is kept and reused.
+ *             Powers by squaring, factorials and multi-operand products as product trees.
+ *             Binary 2^32 words: divide-and-conquer radix conversion and binary products.
+ *             Optional per-phase timing (bigmul_set_stats).
+ *             Optional verification of NTT products modulo random 61-bit primes.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+// Includes
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <time.h>
+#include <unistd.h>
+#include "bigmul.h"
+
+// MACROS AND CONSTANTS
+#define ll long long
+#define ull unsigned long long
+// Both primes are 1 mod 3 * 2^26 (27 * 2^26 + 1 and 15 * 2^27 + 1), so transforms can be 2^k or
+// 3 * 2^k points. MOD_0 * MOD_1 ~ 3.6e18 still fits a signed 64-bit CRT result.
+#define MOD_0 1811939329
+#define MOD_1 2013265921
+#define MAX_LOG_N 23
+#define BASE BIGMUL_BASE
+#define WIDTH BIGMUL_WIDTH
+
+// x / BASE = mul_hi(x, BASE_MAGIC) >> BASE_SHIFT, exact for x < 2^63 (BASE_MAGIC = ceil(2^77 / 10^4))
+#define BASE_MAGIC 0xD1B71758E219652CULL
+#define BASE_SHIFT 13
+// Barrett constants floor(2^64 / MOD_x)
+#define MU_0 0x25ED097AEULL
+#define MU_1 0x22222221DULL
+// Carry normalization works on blocks of 2^CARRY_LOG_BLOCK limbs
+#define CARRY_LOG_BLOCK 12
+#define CARRY_BLOCK (1 << CARRY_LOG_BLOCK)
+// Stages up to 2^NTT_LOG_BLOCK points (128 KiB of limbs) are finished block by block
+#define NTT_LOG_BLOCK 14
+// Transforms below 2^PARALLEL_LOG_N points stay on the calling thread, the team costs more than it saves
+#define PARALLEL_LOG_N 15
+// Work is cut into at least 2^PARTS_PER_THREAD_LOG parts per thread so uneven teams still balance
+#define PARTS_PER_THREAD_LOG 2
+#define MAX_THREADS 1024
+// Algorithm crossovers in limbs of the shorter operand, measured on a single core
+#define KARATSUBA_THRESHOLD 32
+#define TOOM3_THRESHOLD 150
+#define NTT_THRESHOLD 1500
+#define SCRATCH_PER_LIMB 16
+#define SCRATCH_SLACK 256
+// Binary products run on 16-bit digits: n * (2^16)^2 stays below MOD_0 * MOD_1 for every
+// transform length, 2^32 limbs would not
+#define BINARY_BITS 16
+#define BINARY_RADIX (1 << BINARY_BITS)
+#define BINARY_MASK (BINARY_RADIX - 1)
+// Radix conversion leaves: up to CONVERT_LEAF source digits are converted by Horner's rule
+#define CONVERT_LEAF 64
+// Verification residues are taken modulo p = 2^61 - c, c < 2^32 random
+#define VERIFY_BITS 61
+#define VERIFY_MASK ((1ULL << VERIFY_BITS) - 1)
+#define MAX_VERIFY 4
+// Factorial leaves: runs of up to PRODUCT_LEAF integers are multiplied one word at a time
+#define PRODUCT_LEAF 32
+// 3^-1 mod 2^64: exact division by 3 is one wrapping multiply, and mul_hi(x, INV_3) >> 1 == x / 3
+#define INV_3 0xAAAAAAAAAAAAAAABULL
+
+// SWAR masks, one byte per ASCII digit
+#define SWAR_ZERO 0x3030303030303030ULL
+#define SWAR_HIGH_NIBBLES 0xF0F0F0F0F0F0F0F0ULL
+#define SWAR_BIT3 0x0808080808080808ULL
+#define SWAR_BYTE_LANES 0x00FF00FF00FF00FFULL
+#define SWAR_PAIR_LANES 0x0000FFFF0000FFFFULL
+
+#define NS_PER_SECOND 1000000000ULL
+
+// Phase timing: MARK starts a mark, LAP charges the time since it to stats->phase and restarts
+// it. Both cost a pointer test when no stats are attached.
+#define MARK(ctx) ((ctx)->stats ? clock_ns() : 0)
+#define LAP(ctx, mark, phase) do { if ((ctx)->stats) { ull now_ = clock_ns(); (ctx)->stats->phase = fast_add((ctx)->stats->phase, fast_sub(now_, (mark))); (mark) = now_; } } while (0)
+
+// logic bitwise
+#define IS_EQUAL(a, b) (!((a) ^ (b)))
+#define IS_NOT_ZERO(a) (!!(a))
+#define IS_LESS(a, b) (((subtract((a), (b))) >> 63) & 1)
+#define IS_GREATER(a, b) IS_LESS(b, a)
+#define IS_GREATER_EQUAL(a, b) (!IS_LESS(a, b))
+#define FAST_LESS(a, b) ((fast_sub((a), (b)) >> 63) & 1)
+
+static const ll primes[2] = { MOD_0, MOD_1 };
+static const ll prime_roots[2] = { 13, 31 };
+static const ull mus[2] = { MU_0, MU_1 };
+
+// Arithmetic and mod operations
+static ll add(ll a, ll b) { ll carry; add_loop: if (!!b) { carry = a & b; a = a ^ b; b = carry << 1; goto add_loop; } return a; }
+static ll subtract(ll a, ll b) { ll borrow; sub_loop: if (!!b) { borrow = (~a) & b; a = a ^ b; b = borrow << 1; goto sub_loop; } return a; }
+static ll mul(ll a, ll b) { ll res = 0; mul_loop: if (IS_GREATER(b, 0)) { if (b & 1) { res = add(res, a); } a = a << 1; b = b >> 1; goto mul_loop; } return res; }
+static ll mod_add(ll a, ll b, ll m) { ll res = add(a, b); if (IS_GREATER_EQUAL(res, m)) { res = subtract(res, m); } return res; }
+static ll mod_mul(ll a, ll b, ll m) { ll res = 0; mul_loop: if (IS_GREATER(b, 0)) { if (b & 1) { res = mod_add(res, a, m); } a = mod_add(a, a, m); b = b >> 1; goto mul_loop; } return res; }
+static ll power(ll base, ll exp, ll m) { ll res = 1; pow_loop: if (IS_GREATER(exp, 0)) { if (exp & 1) { res = mod_mul(res, base, m); } base = mod_mul(base, base, m); exp = exp >> 1; goto pow_loop; } return res; }
+static ll modInverse(ll n, ll m) { return power(n, subtract(m, 2), m); }
+
+// Native forms for the hot paths, the builtins lower to single add/sub/mul instructions
+static inline ull fast_add(ull a, ull b) { ull res; __builtin_add_overflow(a, b, &res); return res; }
+static inline ull fast_sub(ull a, ull b) { ull res; __builtin_sub_overflow(a, b, &res); return res; }
+static inline ull fast_mul(ull a, ull b) { ull res; __builtin_mul_overflow(a, b, &res); return res; }
+static inline ull mul_hi(ull a, ull b) { unsigned __int128 res; __builtin_mul_overflow((unsigned __int128)a, b, &res); return res >> 64; }
+static inline ull div_base(ull x) { return mul_hi(x, BASE_MAGIC) >> BASE_SHIFT; }
+// a * b mod m for a, b < m < 2^31, mu = floor(2^64 / m); the Barrett quotient is short by at most 2
+static inline ull fast_mod_mul(ull a, ull b, ull m, ull mu) {
+    ull x = fast_mul(a, b), res = fast_sub(x, fast_mul(mul_hi(x, mu), m));
+    if (!FAST_LESS(res, m)) { res = fast_sub(res, m); }
+    if (!FAST_LESS(res, m)) { res = fast_sub(res, m); }
+    return res;
+}
+static ull fast_power(ull base, ull exp, ull m, ull mu) {
+    ull res = 1;
+pow_loop:
+    if (IS_NOT_ZERO(exp)) {
+        if (exp & 1) { res = fast_mod_mul(res, base, m, mu); }
+        base = fast_mod_mul(base, base, m, mu);
+        exp = exp >> 1;
+        goto pow_loop;
+    }
+    return res;
+}
+static inline ull div3(ull x) { return mul_hi(x, INV_3) >> 1; }
+static ull clock_ns(void) { struct timespec t; clock_gettime(CLOCK_MONOTONIC, &t); return fast_add(fast_mul((ull)t.tv_sec, NS_PER_SECOND), (ull)t.tv_nsec); }
+// Splits val into the limb kept (*limb) and the carry out, base BASE or 2^BINARY_BITS
+static inline ull split_limb(ull val, int binary, ll* limb) {
+    ull carry = IS_NOT_ZERO(binary) ? val >> BINARY_BITS : div_base(val);
+    *limb = fast_sub(val, fast_mul(carry, IS_NOT_ZERO(binary) ? BINARY_RADIX : BASE));
+    return carry;
+}
+
+// Context
+// ======================================================================
+// A team task runs once on every thread of the team, tid 0 being the caller
+typedef void (*team_task)(bigmul_ctx* ctx, void* arg, int tid, int threads);
+
+typedef struct {
+    bigmul_ctx* ctx;
+    int tid;
+} worker_arg;
+
+struct bigmul_ctx {
+    int n;                        // prepared buffer length (2^log_n or 3 * 2^log_n), 0 until first use
+    int log_n;                    // radix-2 tables cover 2^log_n points
+    ll* roots[2];                 // roots[p][k] = w^k for w = u^3 a primitive 2^log_n-th root, k < 2^log_n / 2
+    ll* iroots[2];                // same for w^-1
+    ll root3[2], iroot3[2];       // u, a primitive 3 * 2^log_n-th root of primes[p], and u^-1
+    ll* fa[2];                    // per-prime transform buffers
+    ll* fb[2];
+    ll* res;                      // product limbs for the string API
+    ll* block_carry;              // carry out of each normalization block
+    ll* scratch;                  // temporaries for the sub-NTT algorithms
+    size_t scratch_len;
+    ll mod0_inv;                  // MOD_0^-1 mod MOD_1, for CRT
+    int binary;                   // limbs are 2^BINARY_BITS digits while a binary product is in flight
+    bigmul_stats* stats;          // phase timing sink, NULL = off
+    int verify;                   // primes NTT products are checked against, 0 = off
+    ull verify_c[MAX_VERIFY];     // the primes are 2^61 - verify_c[k]
+
+    // Worker pool, see bigmul_set_threads
+    int threads;                  // team size including the caller, 1 = no workers
+    pthread_t* workers;           // workers[1..threads-1]
+    worker_arg* worker_args;
+    pthread_mutex_t lock;
+    pthread_cond_t wake;          // a task was posted or the pool is shutting down
+    pthread_cond_t idle;          // the last worker finished the task
+    pthread_barrier_t stage;      // between NTT stages
+    unsigned generation;          // bumped for every posted task
+    int pending;                  // workers still running the posted task
+    int shutdown;
+    team_task task;
+    void* task_arg;
+};
+
+struct bigmul_prepared {
+    ll* limbs;                    // the operand, trimmed, for partners too short for the transform
+    int len;
+    int max_len;                  // longest partner in limbs
+    int log_m, radix3;            // transform the spectra were taken at
+    ll* spectrum[2];              // forward transform under each prime, NULL when never used
+};
+
+static void release_tables(bigmul_ctx* ctx) {
+    int p = 0;
+    free(ctx->res);
+    free(ctx->block_carry);
+free_loop:
+    if (IS_LESS(p, 2)) {
+        free(ctx->roots[p]); free(ctx->iroots[p]);
+        free(ctx->fa[p]); free(ctx->fb[p]);
+        ctx->roots[p] = ctx->iroots[p] = ctx->fa[p] = ctx->fb[p] = NULL;
+        p = add(p, 1);
+        goto free_loop;
+    }
+    free(ctx->scratch);
+    ctx->res = NULL; ctx->block_carry = NULL; ctx->scratch = NULL; ctx->scratch_len = 0;
+    ctx->n = 0; ctx->log_n = 0;
+}
+
+// Transform lengths run 2, 4, 6, 8, 12, 16, 24, ...: 2^log_m, or 3 * 2^log_m with radix3 set.
+// Returns the first one >= required_len whose radix-2 part fits 2^max_log and which fits max_len.
+static int transform_len(size_t required_len, int max_log, size_t max_len, int* log_m, int* radix3) {
+    int log = 1, three = 0, len = 2;
+len_loop:
+    if (FAST_LESS(len, required_len) | IS_GREATER(log, max_log) | FAST_LESS(max_len, len)) {
+        if (IS_NOT_ZERO(three)) {
+            log = fast_add(log, 2); three = 0;
+        } else if (IS_GREATER(log, 1)) {
+            log = fast_sub(log, 1); three = 1;
+        } else {
+            log = fast_add(log, 1);
+        }
+        len = 1 << log;
+        if (IS_NOT_ZERO(three)) { len = fast_mul(len, 3); }
+        goto len_loop;
+    }
+    *log_m = log;
+    *radix3 = three;
+    return len;
+}
+
+// Replaces the tables with ones for n points (2^log_n or 3 * 2^log_n)
+static int build_tables(bigmul_ctx* ctx, int n, int log_n) {
+    release_tables(ctx);
+    int half = 1 << subtract(log_n, 1), i, p = 0;
+    ctx->res = calloc(n, sizeof(ll));
+    ctx->block_carry = calloc(add(n >> CARRY_LOG_BLOCK, 1), sizeof(ll));
+    int ok = IS_NOT_ZERO(ctx->res) & IS_NOT_ZERO(ctx->block_carry);
+alloc_loop:
+    if (IS_LESS(p, 2)) {
+        ctx->roots[p] = calloc(half, sizeof(ll));
+        ctx->iroots[p] = calloc(half, sizeof(ll));
+        ctx->fa[p] = calloc(n, sizeof(ll));
+        ctx->fb[p] = calloc(n, sizeof(ll));
+        ok = ok & IS_NOT_ZERO(ctx->roots[p]) & IS_NOT_ZERO(ctx->iroots[p]) & IS_NOT_ZERO(ctx->fa[p]) & IS_NOT_ZERO(ctx->fb[p]);
+        p = add(p, 1);
+        goto alloc_loop;
+    }
+    if (!ok) { release_tables(ctx); return BIGMUL_ERR_NOMEM; }
+
+    // w = u^3 keeps the radix-2 twiddles consistent with the radix-3 pass, whose
+    // m-th roots are powers of u
+    p = 0;
+prime_loop:
+    if (IS_LESS(p, 2)) {
+        ll mod = primes[p];
+        ll u = power(prime_roots[p], div3(subtract(mod, 1) >> log_n), mod);
+        ll w = power(u, 3, mod), w_inv = modInverse(w, mod);
+        ctx->root3[p] = u;
+        ctx->iroot3[p] = modInverse(u, mod);
+        ctx->roots[p][0] = 1; ctx->iroots[p][0] = 1;
+        i = 1;
+    root_loop:
+        if (IS_LESS(i, half)) {
+            ctx->roots[p][i] = fast_mod_mul(ctx->roots[p][fast_sub(i, 1)], w, mod, mus[p]);
+            ctx->iroots[p][i] = fast_mod_mul(ctx->iroots[p][fast_sub(i, 1)], w_inv, mod, mus[p]);
+            i = fast_add(i, 1);
+            goto root_loop;
+        }
+        p = add(p, 1);
+        goto prime_loop;
+    }
+
+    ctx->n = n;
+    ctx->log_n = log_n;
+    return BIGMUL_OK;
+}
+
+// Makes sure the tables cover a transform of at least required_len points
+static int prepare(bigmul_ctx* ctx, size_t required_len) {
+    if (IS_GREATER(required_len, 1 << MAX_LOG_N)) { return BIGMUL_ERR_SIZE; }
+    if (!FAST_LESS(ctx->n, required_len)) { return BIGMUL_OK; }
+
+    int log_n, radix3;
+    int n = transform_len(required_len, MAX_LOG_N, 1 << MAX_LOG_N, &log_n, &radix3);
+    return build_tables(ctx, n, log_n);
+}
+
+// Makes sure the tables run this exact transform. prepare alone may settle on 3 * 2^k tables,
+// which do not reach 2^(k + 1) points; power-of-two tables reach every shape up to their length,
+// so the rebuild takes the first one covering both the transform and the old tables.
+static int prepare_transform(bigmul_ctx* ctx, int log_m, int radix3) {
+    int n = 1 << log_m, log_n = log_m;
+    if (IS_NOT_ZERO(radix3)) { n = fast_mul(n, 3); }
+    if (!IS_LESS(ctx->log_n, log_m) & !FAST_LESS(ctx->n, n)) { return BIGMUL_OK; }
+grow_loop:
+    if (FAST_LESS(1 << log_n, n) | FAST_LESS(1 << log_n, ctx->n)) { log_n = fast_add(log_n, 1); goto grow_loop; }
+    return build_tables(ctx, 1 << log_n, log_n);
+}
+
+// Worker pool
+// ======================================================================
+static void* worker_main(void* p) {
+    worker_arg* self = p;
+    bigmul_ctx* ctx = self->ctx;
+    pthread_mutex_lock(&ctx->lock);
+    unsigned seen = ctx->generation;
+wait_loop:
+    if (IS_EQUAL(ctx->generation, seen) & !ctx->shutdown) {
+        pthread_cond_wait(&ctx->wake, &ctx->lock);
+        goto wait_loop;
+    }
+    if (IS_NOT_ZERO(ctx->shutdown)) {
+        pthread_mutex_unlock(&ctx->lock);
+        return NULL;
+    }
+    seen = ctx->generation;
+    team_task task = ctx->task;
+    void* arg = ctx->task_arg;
+    int threads = ctx->threads;
+    pthread_mutex_unlock(&ctx->lock);
+
+    task(ctx, arg, self->tid, threads);
+
+    pthread_mutex_lock(&ctx->lock);
+    ctx->pending = subtract(ctx->pending, 1);
+    if (IS_EQUAL(ctx->pending, 0)) { pthread_cond_signal(&ctx->idle); }
+    goto wait_loop;
+}
+
+// Runs task on the whole team and returns once every thread is done. Small jobs
+// (parallel == 0) and single-thread contexts run it inline as a team of one.
+static void run_team(bigmul_ctx* ctx, team_task task, void* arg, int parallel) {
+    if (!parallel | !IS_GREATER(ctx->threads, 1)) {
+        task(ctx, arg, 0, 1);
+        return;
+    }
+    pthread_mutex_lock(&ctx->lock);
+    ctx->task = task;
+    ctx->task_arg = arg;
+    ctx->pending = subtract(ctx->threads, 1);
+    ctx->generation = add(ctx->generation, 1);
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->lock);
+
+    task(ctx, arg, 0, ctx->threads);
+
+    pthread_mutex_lock(&ctx->lock);
+idle_loop:
+    if (IS_NOT_ZERO(ctx->pending)) { pthread_cond_wait(&ctx->idle, &ctx->lock); goto idle_loop; }
+    pthread_mutex_unlock(&ctx->lock);
+}
+
+static void stop_pool(bigmul_ctx* ctx) {
+    if (!IS_GREATER(ctx->threads, 1)) { return; }
+    pthread_mutex_lock(&ctx->lock);
+    ctx->shutdown = 1;
+    pthread_cond_broadcast(&ctx->wake);
+    pthread_mutex_unlock(&ctx->lock);
+
+    int t = 1;
+join_loop:
+    if (IS_LESS(t, ctx->threads)) { pthread_join(ctx->workers[t], NULL); t = add(t, 1); goto join_loop; }
+    pthread_barrier_destroy(&ctx->stage);
+    free(ctx->workers);
+    free(ctx->worker_args);
+    ctx->workers = NULL;
+    ctx->worker_args = NULL;
+    ctx->threads = 1;
+    ctx->shutdown = 0;
+}
+
+void bigmul_set_stats(bigmul_ctx* ctx, bigmul_stats* stats) { ctx->stats = stats; }
+
+int bigmul_set_threads(bigmul_ctx* ctx, int threads) {
+    stop_pool(ctx);
+    if (!IS_GREATER(threads, 0)) { threads = sysconf(_SC_NPROCESSORS_ONLN); }
+    if (IS_GREATER(threads, MAX_THREADS)) { threads = MAX_THREADS; }
+    if (!IS_GREATER(threads, 1)) { return 1; }
+
+    ctx->workers = calloc(threads, sizeof(pthread_t));
+    ctx->worker_args = calloc(threads, sizeof(worker_arg));
+    int t = 1;
+    if (ctx->workers && ctx->worker_args) {
+    spawn_loop:
+        if (IS_LESS(t, threads)) {
+            ctx->worker_args[t].ctx = ctx;
+            ctx->worker_args[t].tid = t;
+            // A failed spawn just leaves a smaller team
+            if (IS_EQUAL(pthread_create(&ctx->workers[t], NULL, worker_main, &ctx->worker_args[t]), 0)) {
+                t = add(t, 1);
+                goto spawn_loop;
+            }
+        }
+    }
+    ctx->threads = t;
+    if (IS_EQUAL(t, 1)) {
+        free(ctx->workers);
+        free(ctx->worker_args);
+        ctx->workers = NULL;
+        ctx->worker_args = NULL;
+        return 1;
+    }
+    pthread_barrier_init(&ctx->stage, NULL, t);
+    return t;
+}
+
+bigmul_ctx* bigmul_create(size_t max_digits) {
+    bigmul_ctx* ctx = calloc(1, sizeof(bigmul_ctx));
+    if (!ctx) { return NULL; }
+    ctx->mod0_inv = modInverse(MOD_0, MOD_1);
+    ctx->threads = 1;
+    pthread_mutex_init(&ctx->lock, NULL);
+    pthread_cond_init(&ctx->wake, NULL);
+    pthread_cond_init(&ctx->idle, NULL);
+    if (IS_NOT_ZERO(max_digits)) {
+        if (IS_NOT_ZERO(prepare(ctx, add(bigmul_limbs_for(max_digits), 1)))) { bigmul_destroy(ctx); return NULL; }
+    }
+    return ctx;
+}
+
+void bigmul_destroy(bigmul_ctx* ctx) {
+    if (!ctx) { return; }
+    stop_pool(ctx);
+    pthread_mutex_destroy(&ctx->lock);
+    pthread_cond_destroy(&ctx->wake);
+    pthread_cond_destroy(&ctx->idle);
+    release_tables(ctx);
+    free(ctx);
+}
+
+// NTTs
+// ======================================================================
+// Forward transforms are decimation-in-frequency (natural order in, bit-reversed out) and the
+// inverse is decimation-in-time (bit-reversed in, natural out), so no permutation pass is needed:
+// the pointwise product does not care about the order. The inverse is left unscaled, n^-1 is
+// folded into the pointwise product instead.
+//
+// Stages up to 2^NTT_LOG_BLOCK points are run block by block, all of them while the block is in
+// cache. The wider stages are fused two at a time into radix-4 passes over the whole array.
+//
+// A 3 * 2^k transform starts (forward) or ends (inverse) with one radix-3 pass that splits the
+// array into three 2^k blocks, each then transformed like a power-of-two array of its own.
+
+// Up to four same-size transforms shared by one team, e.g. a and b under both primes.
+// Each array holds 2^log_m points, three times that with radix3 set.
+typedef struct {
+    ll* arrays[4];
+    int primes[4];
+    int count, log_m, radix3, invert;
+} ntt_batch;
+
+static inline ull fast_mod_add(ull a, ull b, ull m) { ull res = fast_add(a, b); if (!FAST_LESS(res, m)) { res = fast_sub(res, m); } return res; }
+static inline ull fast_mod_sub(ull a, ull b, ull m) { ull res = fast_sub(a, b); if (FAST_LESS(a, b)) { res = fast_add(res, m); } return res; }
+
+// Radix-2 butterflies [from, to) of the stage with half-length h = 2^(log_len - 1).
+// Butterfly b pairs pos1 = (b / h) * 2h + b % h with pos2 = pos1 + h.
+static void dif2(const bigmul_ctx* ctx, ll a[], int prime, int log_len, int from, int to) {
+    ull mod = primes[prime], mu = mus[prime];
+    const ll* w_table = ctx->roots[prime];
+    int log_half = fast_sub(log_len, 1), half_len = 1 << log_half, w_shift = fast_sub(ctx->log_n, log_len);
+    int b = from;
+butterfly_loop:
+    if (FAST_LESS(b, to)) {
+        int k = b & fast_sub(half_len, 1);
+        int pos1 = ((b >> log_half) << log_len) | k, pos2 = pos1 | half_len;
+        ull u = a[pos1], v = a[pos2];
+        a[pos1] = fast_mod_add(u, v, mod);
+        a[pos2] = fast_mod_mul(fast_mod_sub(u, v, mod), w_table[k << w_shift], mod, mu);
+        b = fast_add(b, 1);
+        goto butterfly_loop;
+    }
+}
+
+static void dit2(const bigmul_ctx* ctx, ll a[], int prime, int log_len, int from, int to) {
+    ull mod = primes[prime], mu = mus[prime];
+    const ll* w_table = ctx->iroots[prime];
+    int log_half = fast_sub(log_len, 1), half_len = 1 << log_half, w_shift = fast_sub(ctx->log_n, log_len);
+    int b = from;
+butterfly_loop:
+    if (FAST_LESS(b, to)) {
+        int k = b & fast_sub(half_len, 1);
+        int pos1 = ((b >> log_half) << log_len) | k, pos2 = pos1 | half_len;
+        ull u = a[pos1], v = fast_mod_mul(a[pos2], w_table[k << w_shift], mod, mu);
+        a[pos1] = fast_mod_add(u, v, mod);
+        a[pos2] = fast_mod_sub(u, v, mod);
+        b = fast_add(b, 1);
+        goto butterfly_loop;
+    }
+}
+
+// Radix-4 butterflies [from, to) doing stages log_len and log_len - 1 in one pass. With
+// q = 2^(log_len - 2), butterfly r works on base + {0, q, 2q, 3q}, base = (r / q) * 4q + r % q.
+static void dif4(const bigmul_ctx* ctx, ll a[], int prime, int log_len, int from, int to) {
+    ull mod = primes[prime], mu = mus[prime];
+    const ll* w_table = ctx->roots[prime];
+    int log_q = fast_sub(log_len, 2), q = 1 << log_q, w_shift = fast_sub(ctx->log_n, log_len);
+    int r = from;
+butterfly_loop:
+    if (FAST_LESS(r, to)) {
+        int k = r & fast_sub(q, 1);
+        int i0 = ((r >> log_q) << log_len) | k, i1 = i0 | q, i2 = i0 | (q << 1), i3 = i1 | (q << 1);
+        ull w1 = w_table[k << w_shift], w1q = w_table[(k | q) << w_shift], w2 = w_table[k << add(w_shift, 1)];
+        ull a0 = a[i0], a1 = a[i1], a2 = a[i2], a3 = a[i3];
+        ull b0 = fast_mod_add(a0, a2, mod), b2 = fast_mod_mul(fast_mod_sub(a0, a2, mod), w1, mod, mu);
+        ull b1 = fast_mod_add(a1, a3, mod), b3 = fast_mod_mul(fast_mod_sub(a1, a3, mod), w1q, mod, mu);
+        a[i0] = fast_mod_add(b0, b1, mod);
+        a[i1] = fast_mod_mul(fast_mod_sub(b0, b1, mod), w2, mod, mu);
+        a[i2] = fast_mod_add(b2, b3, mod);
+        a[i3] = fast_mod_mul(fast_mod_sub(b2, b3, mod), w2, mod, mu);
+        r = fast_add(r, 1);
+        goto butterfly_loop;
+    }
+}
+
+// Inverse of dif4: stage log_len - 1, then stage log_len
+static void dit4(const bigmul_ctx* ctx, ll a[], int prime, int log_len, int from, int to) {
+    ull mod = primes[prime], mu = mus[prime];
+    const ll* w_table = ctx->iroots[prime];
+    int log_q = fast_sub(log_len, 2), q = 1 << log_q, w_shift = fast_sub(ctx->log_n, log_len);
+    int r = from;
+butterfly_loop:
+    if (FAST_LESS(r, to)) {
+        int k = r & fast_sub(q, 1);
+        int i0 = ((r >> log_q) << log_len) | k, i1 = i0 | q, i2 = i0 | (q << 1), i3 = i1 | (q << 1);
+        ull w1 = w_table[k << w_shift], w1q = w_table[(k | q) << w_shift], w2 = w_table[k << add(w_shift, 1)];
+        ull a0 = a[i0], a2 = a[i2];
+        ull v1 = fast_mod_mul(a[i1], w2, mod, mu), v3 = fast_mod_mul(a[i3], w2, mod, mu);
+        ull b0 = fast_mod_add(a0, v1, mod), b1 = fast_mod_sub(a0, v1, mod);
+        ull b2 = fast_mod_add(a2, v3, mod), b3 = fast_mod_sub(a2, v3, mod);
+        ull v2 = fast_mod_mul(b2, w1, mod, mu), v3q = fast_mod_mul(b3, w1q, mod, mu);
+        a[i0] = fast_mod_add(b0, v2, mod);
+        a[i2] = fast_mod_sub(b0, v2, mod);
+        a[i1] = fast_mod_add(b1, v3q, mod);
+        a[i3] = fast_mod_sub(b1, v3q, mod);
+        r = fast_add(r, 1);
+        goto butterfly_loop;
+    }
+}
+
+// Radix-3 points [from, to) of a 3 * 2^log_m transform, M = 2^log_m, w = u^(2^log_n / M) the
+// transform's primitive root and c = w^M a cube root of unity. Forward (DIF):
+//   a[i], a[i + M], a[i + 2M] <- (x0 + x1 + x2, (x0 + c x1 + c^2 x2) w^i, (x0 + c^2 x1 + c x2) w^2i)
+// and the inverse undoes it with w^-1 after the blocks are back in natural order. c^2 = -1 - c
+// turns the middle terms into x0 - x2 + d and x0 - x1 - d with d = c (x1 - x2).
+static void radix3_pass(const bigmul_ctx* ctx, ll a[], int prime, int log_m, int invert, int from, int to) {
+    ull mod = primes[prime], mu = mus[prime];
+    ull w = IS_NOT_ZERO(invert) ? ctx->iroot3[prime] : ctx->root3[prime];
+    int M = 1 << log_m, M2 = M << 1, i = from;
+    w = fast_power(w, 1ULL << fast_sub(ctx->log_n, log_m), mod, mu);
+    ull c = fast_power(w, M, mod, mu), t = fast_power(w, from, mod, mu);
+pass_loop:
+    if (FAST_LESS(i, to)) {
+        ull t2 = fast_mod_mul(t, t, mod, mu);
+        ull x0 = a[i], x1 = a[fast_add(i, M)], x2 = a[fast_add(i, M2)];
+        if (IS_NOT_ZERO(invert)) {
+            x1 = fast_mod_mul(x1, t, mod, mu);
+            x2 = fast_mod_mul(x2, t2, mod, mu);
+        }
+        ull d = fast_mod_mul(fast_mod_sub(x1, x2, mod), c, mod, mu);
+        ull y0 = fast_mod_add(fast_mod_add(x0, x1, mod), x2, mod);
+        ull y1 = fast_mod_add(fast_mod_sub(x0, x2, mod), d, mod);
+        ull y2 = fast_mod_sub(fast_mod_sub(x0, x1, mod), d, mod);
+        if (!IS_NOT_ZERO(invert)) {
+            y1 = fast_mod_mul(y1, t, mod, mu);
+            y2 = fast_mod_mul(y2, t2, mod, mu);
+        }
+        a[i] = y0;
+        a[fast_add(i, M)] = y1;
+        a[fast_add(i, M2)] = y2;
+        t = fast_mod_mul(t, w, mod, mu);
+        i = fast_add(i, 1);
+        goto pass_loop;
+    }
+}
+
+// Stages [log_lo, log_hi] (widest first forward, narrowest first inverse) restricted to part p of
+// 2^log_parts: butterflies [p, p + 1) * (m / 2 or m / 4) / 2^log_parts. For stages no wider than
+// a part that is exactly the part's own block of elements.
+static void run_stages(const bigmul_ctx* ctx, const ntt_batch* job, ll a[], int prime, int log_lo, int log_hi, int log_parts, int p) {
+    int log_bfly2 = fast_sub(fast_sub(job->log_m, 1), log_parts), log_bfly4 = fast_sub(log_bfly2, 1);
+    int next = fast_add(p, 1);
+    if (!IS_NOT_ZERO(job->invert)) {
+    dif_loop:
+        if (!FAST_LESS(log_hi, log_lo)) {
+            if (FAST_LESS(log_lo, log_hi)) {
+                dif4(ctx, a, prime, log_hi, p << log_bfly4, next << log_bfly4);
+                log_hi = fast_sub(log_hi, 2);
+            } else {
+                dif2(ctx, a, prime, log_hi, p << log_bfly2, next << log_bfly2);
+                log_hi = fast_sub(log_hi, 1);
+            }
+            goto dif_loop;
+        }
+    } else {
+    dit_loop:
+        if (!FAST_LESS(log_hi, log_lo)) {
+            if (FAST_LESS(log_lo, log_hi)) {
+                dit4(ctx, a, prime, fast_add(log_lo, 1), p << log_bfly4, next << log_bfly4);
+                log_lo = fast_add(log_lo, 2);
+            } else {
+                dit2(ctx, a, prime, log_lo, p << log_bfly2, next << log_bfly2);
+                log_lo = fast_add(log_lo, 1);
+            }
+            goto dit_loop;
+        }
+    }
+}
+
+// This thread's parts (p = tid, tid + threads, ...) of every array in the batch, and of each of
+// the three blocks of a radix-3 array
+static void ntt_stages(const bigmul_ctx* ctx, const ntt_batch* job, int log_lo, int log_hi, int log_parts, int tid, int threads) {
+    int parts = 1 << log_parts, blocks = IS_NOT_ZERO(job->radix3) ? 3 : 1, j = 0;
+array_loop:
+    if (FAST_LESS(j, job->count)) {
+        int block = 0;
+    block_loop:
+        if (FAST_LESS(block, blocks)) {
+            ll* a = &job->arrays[j][fast_mul(block, 1 << job->log_m)];
+            int p = tid;
+        part_loop:
+            if (FAST_LESS(p, parts)) {
+                run_stages(ctx, job, a, job->primes[j], log_lo, log_hi, log_parts, p);
+                p = fast_add(p, threads);
+                goto part_loop;
+            }
+            block = fast_add(block, 1);
+            goto block_loop;
+        }
+        j = fast_add(j, 1);
+        goto array_loop;
+    }
+}
+
+static void radix3_parts(const bigmul_ctx* ctx, const ntt_batch* job, int log_parts, int tid, int threads) {
+    int parts = 1 << log_parts, log_chunk = fast_sub(job->log_m, log_parts), j = 0;
+array_loop:
+    if (FAST_LESS(j, job->count)) {
+        int p = tid;
+    part_loop:
+        if (FAST_LESS(p, parts)) {
+            radix3_pass(ctx, job->arrays[j], job->primes[j], job->log_m, job->invert, p << log_chunk, fast_add(p, 1) << log_chunk);
+            p = fast_add(p, threads);
+            goto part_loop;
+        }
+        j = fast_add(j, 1);
+        goto array_loop;
+    }
+}
+
+static void stage_sync(bigmul_ctx* ctx, int threads) {
+    if (IS_GREATER(threads, 1)) { pthread_barrier_wait(&ctx->stage); }
+}
+
+// Blocks are at most 2^NTT_LOG_BLOCK points and at least PARTS_PER_THREAD per thread. Only the
+// wide passes need the barrier, each thread owns its blocks for the narrow stages.
+static void ntt_task(bigmul_ctx* ctx, void* arg, int tid, int threads) {
+    const ntt_batch* job = arg;
+    int log_m = job->log_m, log_parts = 0, max_log_parts = 0;
+    if (IS_GREATER(log_m, 2)) { max_log_parts = fast_sub(log_m, 2); }
+parts_loop:
+    if ((FAST_LESS(1 << log_parts, threads << PARTS_PER_THREAD_LOG) | IS_GREATER(fast_sub(log_m, log_parts), NTT_LOG_BLOCK)) &
+        FAST_LESS(log_parts, max_log_parts)) {
+        log_parts = fast_add(log_parts, 1);
+        goto parts_loop;
+    }
+    int log_chunk = fast_sub(log_m, log_parts), log_len;
+
+    if (!IS_NOT_ZERO(job->invert)) {
+        if (IS_NOT_ZERO(job->radix3)) {
+            radix3_parts(ctx, job, log_parts, tid, threads);
+            stage_sync(ctx, threads);
+        }
+        log_len = log_m;
+    dif_pass_loop:
+        if (IS_GREATER(log_len, log_chunk)) {
+            int log_lo = subtract(log_len, 1);
+            if (!IS_GREATER(log_lo, log_chunk)) { log_lo = log_len; }
+            ntt_stages(ctx, job, log_lo, log_len, log_parts, tid, threads);
+            stage_sync(ctx, threads);
+            log_len = fast_sub(log_lo, 1);
+            goto dif_pass_loop;
+        }
+        ntt_stages(ctx, job, 1, log_chunk, log_parts, tid, threads);
+    } else {
+        ntt_stages(ctx, job, 1, log_chunk, log_parts, tid, threads);
+        log_len = fast_add(log_chunk, 1);
+    dit_pass_loop:
+        if (!IS_GREATER(log_len, log_m)) {
+            stage_sync(ctx, threads);
+            int log_hi = add(log_len, 1);
+            if (IS_GREATER(log_hi, log_m)) { log_hi = log_len; }
+            ntt_stages(ctx, job, log_len, log_hi, log_parts, tid, threads);
+            log_len = fast_add(log_hi, 1);
+            goto dit_pass_loop;
+        }
+        if (IS_NOT_ZERO(job->radix3)) {
+            stage_sync(ctx, threads);
+            radix3_parts(ctx, job, log_parts, tid, threads);
+        }
+    }
+}
+
+// Small products
+// ======================================================================
+// Below NTT_THRESHOLD limbs on the shorter side the product is done as a plain integer
+// polynomial product: coefficients are only carried once at the end, and the Toom-3
+// evaluations make them signed on the way. Magnitudes stay far below 2^63 at these sizes.
+// Each routine writes la + lb - 1 coefficients to out and takes its temporaries from scratch.
+
+static void poly_mul(const ll a[], int la, const ll b[], int lb, ll out[], ll scratch[]);
+
+static void add_into(ll dst[], const ll src[], int len) {
+    int i = 0;
+add_loop:
+    if (FAST_LESS(i, len)) { dst[i] = fast_add(dst[i], src[i]); i = fast_add(i, 1); goto add_loop; }
+}
+
+static void sub_from(ll dst[], const ll src[], int len) {
+    int i = 0;
+sub_loop:
+    if (FAST_LESS(i, len)) { dst[i] = fast_sub(dst[i], src[i]); i = fast_add(i, 1); goto sub_loop; }
+}
+
+static void schoolbook(const ll a[], int la, const ll b[], int lb, ll out[]) {
+    int len = fast_sub(fast_add(la, lb), 1), i = 0;
+    memset(out, 0, fast_mul(len, sizeof(ll)));
+row_loop:
+    if (FAST_LESS(i, la)) {
+        ll ai = a[i], *row = &out[i];
+        int j = 0;
+    col_loop:
+        if (FAST_LESS(j, lb)) { row[j] = fast_add(row[j], fast_mul(ai, b[j])); j = fast_add(j, 1); goto col_loop; }
+        i = fast_add(i, 1);
+        goto row_loop;
+    }
+}
+
+// lb <= ceil(la / 2): lb-sized slices of a against all of b, summed at their offsets
+static void chunked(const ll a[], int la, const ll b[], int lb, ll out[], ll scratch[]) {
+    ll* piece_out = scratch;
+    ll* rest = &scratch[fast_add(lb, lb)];
+    memset(out, 0, fast_mul(fast_sub(fast_add(la, lb), 1), sizeof(ll)));
+    int off = 0;
+chunk_loop:
+    if (FAST_LESS(off, la)) {
+        int piece = fast_sub(la, off);
+        if (FAST_LESS(lb, piece)) { piece = lb; }
+        poly_mul(&a[off], piece, b, lb, piece_out, rest);
+        add_into(&out[off], piece_out, fast_sub(fast_add(piece, lb), 1));
+        off = fast_add(off, lb);
+        goto chunk_loop;
+    }
+}
+
+// Split at m = ceil(la / 2), needs lb > m: z0 = a0 b0, z2 = a1 b1, z1 = (a0 + a1)(b0 + b1) - z0 - z2
+static void karatsuba(const ll a[], int la, const ll b[], int lb, ll out[], ll scratch[]) {
+    int m = fast_add(la, 1) >> 1, ha = fast_sub(la, m), hb = fast_sub(lb, m);
+    int m2 = fast_add(m, m), z1_len = fast_sub(m2, 1);
+    ll *sa = scratch, *sb = &scratch[m], *z1 = &scratch[m2], *rest = &scratch[fast_add(m2, m2)];
+
+    memcpy(sa, a, fast_mul(m, sizeof(ll)));
+    memcpy(sb, b, fast_mul(m, sizeof(ll)));
+    add_into(sa, &a[m], ha);
+    add_into(sb, &b[m], hb);
+
+    poly_mul(a, m, b, m, out, rest);
+    out[z1_len] = 0;
+    poly_mul(&a[m], ha, &b[m], hb, &out[m2], rest);
+    poly_mul(sa, m, sb, m, z1, rest);
+
+    sub_from(z1, out, z1_len);
+    sub_from(z1, &out[m2], fast_sub(fast_add(ha, hb), 1));
+    add_into(&out[m], z1, z1_len);
+}
+
+// Split in three at k = ceil(la / 3), needs lb > 2k. Evaluates at 0, 1, -1, -2, inf and
+// interpolates with Bodrato's sequence; the divisions by 2 and 3 are all exact.
+static void toom3(const ll a[], int la, const ll b[], int lb, ll out[], ll scratch[]) {
+    int k = div3(fast_add(la, 2)), k2 = fast_add(k, k), k4 = fast_add(k2, k2);
+    int la2 = fast_sub(la, k2), lb2 = fast_sub(lb, k2), r_len = fast_sub(k2, 1);
+    int inf_len = fast_sub(fast_add(la2, lb2), 1), i = 0;
+    ll *ea1 = scratch, *eam1 = &scratch[k], *eam2 = &scratch[k2];
+    ll *eb1 = &scratch[fast_mul(k, 3)], *ebm1 = &scratch[k4], *ebm2 = &scratch[fast_mul(k, 5)];
+    ll *r1 = &scratch[fast_mul(k, 6)], *rm1 = &scratch[fast_mul(k, 8)], *rm2 = &scratch[fast_mul(k, 10)];
+    ll* rest = &scratch[fast_mul(k, 12)];
+
+eval_loop:
+    if (FAST_LESS(i, k)) {
+        ll x0 = a[i], x1 = a[fast_add(k, i)], x2 = FAST_LESS(i, la2) ? a[fast_add(k2, i)] : 0;
+        ll y0 = b[i], y1 = b[fast_add(k, i)], y2 = FAST_LESS(i, lb2) ? b[fast_add(k2, i)] : 0;
+        ll px = fast_add(x0, x2), py = fast_add(y0, y2);
+        ea1[i] = fast_add(px, x1);
+        eam1[i] = fast_sub(px, x1);
+        eam2[i] = fast_sub(fast_mul(fast_add(eam1[i], x2), 2), x0);
+        eb1[i] = fast_add(py, y1);
+        ebm1[i] = fast_sub(py, y1);
+        ebm2[i] = fast_sub(fast_mul(fast_add(ebm1[i], y2), 2), y0);
+        i = fast_add(i, 1);
+        goto eval_loop;
+    }
+
+    poly_mul(a, k, b, k, out, rest);
+    poly_mul(&a[k2], la2, &b[k2], lb2, &out[k4], rest);
+    memset(&out[r_len], 0, fast_mul(fast_sub(k4, r_len), sizeof(ll)));
+    poly_mul(ea1, k, eb1, k, r1, rest);
+    poly_mul(eam1, k, ebm1, k, rm1, rest);
+    poly_mul(eam2, k, ebm2, k, rm2, rest);
+
+    i = 0;
+interpolate_loop:
+    if (FAST_LESS(i, r_len)) {
+        ll r0 = out[i], rinf = FAST_LESS(i, inf_len) ? out[fast_add(k4, i)] : 0;
+        ll v3 = fast_mul(fast_sub(rm2[i], r1[i]), INV_3);
+        ll v1 = (ll)fast_sub(r1[i], rm1[i]) >> 1;
+        ll v2 = fast_sub(rm1[i], r0);
+        v3 = fast_add((ll)fast_sub(v2, v3) >> 1, fast_mul(rinf, 2));
+        v2 = fast_sub(fast_add(v2, v1), rinf);
+        r1[i] = fast_sub(v1, v3);
+        rm1[i] = v2;
+        rm2[i] = v3;
+        i = fast_add(i, 1);
+        goto interpolate_loop;
+    }
+
+    // r3 x^3k may poke past the top coefficient, those terms are zero
+    int r3_len = fast_sub(fast_sub(fast_add(la, lb), 1), fast_mul(k, 3));
+    if (FAST_LESS(r_len, r3_len)) { r3_len = r_len; }
+    add_into(&out[k], r1, r_len);
+    add_into(&out[k2], rm1, r_len);
+    add_into(&out[fast_mul(k, 3)], rm2, r3_len);
+}
+
+static void poly_mul(const ll a[], int la, const ll b[], int lb, ll out[], ll scratch[]) {
+    if (FAST_LESS(la, lb)) {
+        const ll* t = a; a = b; b = t;
+        int tl = la; la = lb; lb = tl;
+    }
+    if (FAST_LESS(lb, KARATSUBA_THRESHOLD)) {
+        schoolbook(a, la, b, lb, out);
+    } else if (!FAST_LESS(fast_add(la, 1) >> 1, lb)) {
+        chunked(a, la, b, lb, out, scratch);
+    } else if ((!FAST_LESS(lb, TOOM3_THRESHOLD)) & FAST_LESS(fast_mul(div3(fast_add(la, 2)), 2), lb)) {
+        toom3(a, la, b, lb, out, scratch);
+    } else {
+        karatsuba(a, la, b, lb, out, scratch);
+    }
+}
+
+// Every split keeps the shorter side at or below the caller's, each level takes at most
+// ~8 lb of temporaries and the sizes shrink geometrically
+static int reserve_scratch(bigmul_ctx* ctx, size_t lb) {
+    size_t need = fast_add(fast_mul(lb, SCRATCH_PER_LIMB), SCRATCH_SLACK);
+    if (!FAST_LESS(ctx->scratch_len, need)) { return BIGMUL_OK; }
+    free(ctx->scratch);
+    ctx->scratch = malloc(fast_mul(need, sizeof(ll)));
+    ctx->scratch_len = ctx->scratch ? need : 0;
+    return ctx->scratch ? BIGMUL_OK : BIGMUL_ERR_NOMEM;
+}
+
+// a * b into out (len_a + len_b limbs, carried)
+static int multiply_small(bigmul_ctx* ctx, const ll a[], int len_a, const ll b[], int len_b, ll out[]) {
+    ull mark = MARK(ctx);
+    int status = reserve_scratch(ctx, FAST_LESS(len_a, len_b) ? len_a : len_b);
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    int len = fast_add(len_a, len_b);
+    poly_mul(a, len_a, b, len_b, out, ctx->scratch);
+    out[fast_sub(len, 1)] = 0;
+
+    ull carry = 0;
+    int i = 0;
+carry_loop:
+    if (FAST_LESS(i, len)) {
+        carry = split_limb(fast_add(out[i], carry), ctx->binary, &out[i]);
+        i = fast_add(i, 1);
+        goto carry_loop;
+    }
+    LAP(ctx, mark, small);
+    return BIGMUL_OK;
+}
+
+// Verification
+// ======================================================================
+// A wrong NTT product (coefficient bound exceeded, a bad twiddle) is caught by comparing
+// (a mod p) * (b mod p) with (a * b mod p) for a few random 61-bit primes. With p = 2^61 - c,
+// hi * 2^61 + lo == hi * c + lo, so each Horner step is a couple of multiply-adds: O(n)
+// against the O(n log n) product.
+
+// Full 128-bit a * b and a * b + c, neither can wrap for the operands used here
+static inline unsigned __int128 wide_mul(ull a, ull b) { unsigned __int128 res; __builtin_mul_overflow((unsigned __int128)a, b, &res); return res; }
+static inline unsigned __int128 wide_mul_add(ull a, ull b, unsigned __int128 c) { unsigned __int128 res; __builtin_add_overflow(wide_mul(a, b), c, &res); return res; }
+// One fold: hi * c + lo, x must be below 2^125 so hi fits a word
+static inline unsigned __int128 fold_step(unsigned __int128 x, ull c) { return wide_mul_add((ull)(x >> VERIFY_BITS), c, x & VERIFY_MASK); }
+
+// x mod 2^61 - c for x < 2^125
+static ull fold(unsigned __int128 x, ull c) {
+fold_loop:
+    if (IS_NOT_ZERO((ull)(x >> VERIFY_BITS))) {
+        x = fold_step(x, c);
+        goto fold_loop;
+    }
+    ull res = (ull)x, p = fast_sub(1ULL << VERIFY_BITS, c);
+    if (!FAST_LESS(res, p)) { res = fast_sub(res, p); }
+    return res;
+}
+
+static ull fold_power(ull base, ull exp, ull c) {
+    ull res = 1;
+pow_loop:
+    if (IS_NOT_ZERO(exp)) {
+        if (exp & 1) { res = fold(wide_mul(res, base), c); }
+        base = fold(wide_mul(base, base), c);
+        exp = exp >> 1;
+        goto pow_loop;
+    }
+    return res;
+}
+
+// Miller-Rabin on 2^61 - c with the first twelve prime bases, exact below 3.3e24
+static int is_verify_prime(ull c) {
+    static const ull bases[12] = { 2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37 };
+    ull p = fast_sub(1ULL << VERIFY_BITS, c), d = fast_sub(p, 1);
+    int shift = __builtin_ctzll(d), k = 0, r;
+    d = d >> shift;
+base_loop:
+    if (IS_LESS(k, 12)) {
+        ull x = fold_power(bases[k], d, c);
+        k = fast_add(k, 1);
+        if (IS_EQUAL(x, 1) | IS_EQUAL(x, fast_sub(p, 1))) { goto base_loop; }
+        r = 1;
+    square_loop:
+        if (IS_LESS(r, shift)) {
+            x = fold(wide_mul(x, x), c);
+            if (IS_EQUAL(x, fast_sub(p, 1))) { goto base_loop; }
+            r = fast_add(r, 1);
+            goto square_loop;
+        }
+        return 0;
+    }
+    return 1;
+}
+
+int bigmul_set_verify(bigmul_ctx* ctx, int checks) {
+    // Different primes per context and per call: nobody can aim a product at them
+    ull seed = clock_ns() ^ (ull)(size_t)ctx ^ 0x9E3779B97F4A7C15ULL;
+    int k = 0;
+    if (IS_LESS(checks, 0)) { checks = 0; }
+    if (IS_GREATER(checks, MAX_VERIFY)) { checks = MAX_VERIFY; }
+pick_loop:
+    if (IS_LESS(k, checks)) {
+        seed ^= seed << 13; seed ^= seed >> 7; seed ^= seed << 17;
+        ull c = (seed & 0xFFFFFFFFULL) | 1;
+        if (is_verify_prime(c)) { ctx->verify_c[k] = c; k = fast_add(k, 1); }
+        goto pick_loop;
+    }
+    ctx->verify = checks;
+    return checks;
+}
+
+// x mod 2^61 - c up to a multiple of it, below 2^62, for x < 2^125: three folds, no branches
+static inline ull fold_lazy(unsigned __int128 x, ull c) {
+    x = fold_step(x, c);                                         // < 2^96
+    x = fold_step(x, c);                                         // < 2^67
+    return (ull)fold_step(x, c);
+}
+
+// Limbs [i, i + group) as one number below 2^54, zeros past len
+static inline ull residue_chunk(const ll limbs[], int i, int len, int group, ull radix) {
+    ull chunk = 0;
+    int t = fast_add(i, group);
+    if (FAST_LESS(len, t)) { t = len; }
+chunk_loop:
+    if (FAST_LESS(i, t)) {
+        t = fast_sub(t, 1);
+        chunk = fast_add(fast_mul(chunk, radix), (ull)limbs[t]);
+        goto chunk_loop;
+    }
+    return chunk;
+}
+
+// Value of limbs[0..len) (base BASE, or 2^BINARY_BITS in a binary product) modulo 2^61 - c.
+// Horner over chunks of four limbs (three binary digits), even and odd chunks on two independent
+// chains in step^2 so the multiplies overlap: value = even + step * odd.
+static ull residue(const ll limbs[], int len, ull radix, ull c) {
+    int decimal = IS_EQUAL(radix, BASE), group = decimal ? 4 : 3, span = fast_add(group, group);
+    int chunks = decimal ? (int)(fast_add(len, 3) >> 2) : (int)div3((ull)fast_add(len, 2));
+    int i = fast_mul(fast_sub(chunks, 1) >> 1, span);            // pair holding the top chunk
+    ull step = decimal ? 10000000000000000ULL : 1ULL << fast_mul(BINARY_BITS, 3);
+    ull step2 = fold(wide_mul(step, step), c), even = 0, odd = 0;
+horner_loop:
+    if (!FAST_LESS(i, 0) && IS_NOT_ZERO(chunks)) {
+        even = fold_lazy(wide_mul_add(even, step2, residue_chunk(limbs, i, len, group, radix)), c);
+        odd = fold_lazy(wide_mul_add(odd, step2, residue_chunk(limbs, fast_add(i, group), len, group, radix)), c);
+        i = fast_sub(i, span);
+        goto horner_loop;
+    }
+    return fold(wide_mul_add(odd, step, even), c);
+}
+
+// (a mod p) * (b mod p) for every check, taken before the transforms overwrite the operands
+static void verify_expect(const bigmul_ctx* ctx, const ll a[], int len_a, const ll b[], int len_b, ull expect[]) {
+    ull radix = IS_NOT_ZERO(ctx->binary) ? BINARY_RADIX : BASE;
+    int k = 0;
+expect_loop:
+    if (IS_LESS(k, ctx->verify)) {
+        ull c = ctx->verify_c[k];
+        expect[k] = fold(wide_mul(residue(a, len_a, radix, c), residue(b, len_b, radix, c)), c);
+        k = fast_add(k, 1);
+        goto expect_loop;
+    }
+}
+
+static int verify_product(const bigmul_ctx* ctx, const ll out[], int len, const ull expect[]) {
+    ull radix = IS_NOT_ZERO(ctx->binary) ? BINARY_RADIX : BASE;
+    int k = 0;
+check_loop:
+    if (IS_LESS(k, ctx->verify)) {
+        if (!IS_EQUAL(residue(out, len, radix, ctx->verify_c[k]), expect[k])) { return BIGMUL_ERR_VERIFY; }
+        k = fast_add(k, 1);
+        goto check_loop;
+    }
+    return BIGMUL_OK;
+}
+
+// Main multiplication logic
+// ======================================================================
+
+// CRT-combines the coefficients in [start, end) and writes them as limbs, returns the carry out of the block
+static ll normalize_block(const bigmul_ctx* ctx, int start, int end, ll out[]) {
+    ull carry = 0;
+    int i = start, binary = ctx->binary;
+carry_loop:
+    if (FAST_LESS(i, end)) {
+        // Garner: coeff = r0 + MOD_0 * ((r1 - r0) * MOD_0^-1 mod MOD_1), r0 < MOD_0 < MOD_1
+        ull r0 = ctx->fa[0][i], r1 = ctx->fa[1][i];
+        ull diff = fast_sub(r1, r0);
+        if (FAST_LESS(r1, r0)) { diff = fast_add(diff, MOD_1); }
+        ull coeff = fast_add(r0, fast_mul(MOD_0, fast_mod_mul(diff, ctx->mod0_inv, MOD_1, MU_1)));
+        carry = split_limb(fast_add(coeff, carry), binary, &out[i]);
+        i = fast_add(i, 1);
+        goto carry_loop;
+    }
+    return carry;
+}
+
+// fa[p] = src[p] * fb[p] * n^-1, the scaling the inverse transform leaves out
+typedef struct {
+    ll* const* src;
+    ll* const* fb;
+    int log_m, radix3;
+    ll n_inv[2];
+} pointwise_job;
+
+// Blocks of up to 2^NTT_LOG_BLOCK points handed out round-robin, prime 0 first
+static void pointwise_task(bigmul_ctx* ctx, void* arg, int tid, int threads) {
+    const pointwise_job* job = arg;
+    int log_block = IS_LESS(job->log_m, NTT_LOG_BLOCK) ? job->log_m : NTT_LOG_BLOCK;
+    int blocks = 1 << fast_sub(job->log_m, log_block), block = tid;
+    if (IS_NOT_ZERO(job->radix3)) { blocks = fast_mul(blocks, 3); }
+block_loop:
+    if (FAST_LESS(block, fast_add(blocks, blocks))) {
+        int p = !FAST_LESS(block, blocks);
+        int i = fast_sub(block, fast_mul(p, blocks)) << log_block;
+        int end = fast_add(i, 1 << log_block);
+        ull mod = primes[p], mu = mus[p];
+    pointwise_mul_loop:
+        if (FAST_LESS(i, end)) {
+            ctx->fa[p][i] = fast_mod_mul(fast_mod_mul(job->src[p][i], job->fb[p][i], mod, mu), job->n_inv[p], mod, mu);
+            i = fast_add(i, 1);
+            goto pointwise_mul_loop;
+        }
+        block = fast_add(block, threads);
+        goto block_loop;
+    }
+}
+
+typedef struct {
+    ll* out;
+    int required_len;
+} normalize_job;
+
+static void normalize_task(bigmul_ctx* ctx, void* arg, int tid, int threads) {
+    const normalize_job* job = arg;
+    int block = tid, start = tid << CARRY_LOG_BLOCK;
+block_loop:
+    if (FAST_LESS(start, job->required_len)) {
+        int end = fast_add(start, CARRY_BLOCK);
+        if (FAST_LESS(job->required_len, end)) { end = job->required_len; }
+        ctx->block_carry[block] = normalize_block(ctx, start, end, job->out);
+        block = fast_add(block, threads);
+        start = block << CARRY_LOG_BLOCK;
+        goto block_loop;
+    }
+}
+
+// Everything after the forward transforms: fa[p] = src[p] * fb[p], inverse, CRT and carries
+// into out (required_len limbs)
+static void finish_ntt(bigmul_ctx* ctx, ll* const* src, ll* const* fb, int log_n, int radix3, int required_len, ll out[]) {
+    int parallel = IS_GREATER_EQUAL(log_n, PARALLEL_LOG_N), i;
+    ull mark = MARK(ctx);
+
+    // n divides mod - 1, so n * ((mod - 1) / n) == -1 and n^-1 = mod - (mod - 1) / n
+    ull q0 = (MOD_0 - 1) >> log_n, q1 = (MOD_1 - 1) >> log_n;
+    if (IS_NOT_ZERO(radix3)) { q0 = div3(q0); q1 = div3(q1); }
+    pointwise_job pointwise = { src, fb, log_n, radix3, { fast_sub(MOD_0, q0), fast_sub(MOD_1, q1) } };
+    run_team(ctx, pointwise_task, &pointwise, parallel);
+    LAP(ctx, mark, pointwise);
+
+    ntt_batch inverse = { { ctx->fa[0], ctx->fa[1] }, { 0, 1 }, 2, log_n, radix3, 1 };
+    run_team(ctx, ntt_task, &inverse, parallel);
+    LAP(ctx, mark, inverse);
+
+    // Blocks are independent: each one starts from a zero carry
+    normalize_job normalize = { out, required_len };
+    run_team(ctx, normalize_task, &normalize, parallel);
+
+    // Prefix-carry fixup: a block's incoming carry ripples through a few limbs at most, then
+    // whatever is left over joins that block's own carry. The product has at most
+    // len_a + len_b limbs, so the carry is spent by the last block.
+    ull carry = 0;
+    int block = 0, start = 0;
+fixup_loop:
+    if (FAST_LESS(start, required_len)) {
+        int end = fast_add(start, CARRY_BLOCK);
+        if (FAST_LESS(required_len, end)) { end = required_len; }
+        i = start;
+    ripple_loop:
+        if (IS_NOT_ZERO(carry) & FAST_LESS(i, end)) {
+            carry = split_limb(fast_add(out[i], carry), ctx->binary, &out[i]);
+            i = fast_add(i, 1);
+            goto ripple_loop;
+        }
+        carry = fast_add(carry, ctx->block_carry[block]);
+        block = fast_add(block, 1);
+        start = end;
+        goto fixup_loop;
+    }
+    LAP(ctx, mark, carry);
+}
+
+// NTT product of the limbs already loaded in fa[0] / fb[0] into out (len_a + len_b limbs).
+// With square set only fa[0] is used (len_b == len_a): one forward transform, pointwise a * a.
+static void multiply_ntt(bigmul_ctx* ctx, int len_a, int len_b, int square, ll out[]) {
+    ll* const* fb = IS_NOT_ZERO(square) ? ctx->fa : ctx->fb;
+    int log_n, radix3;
+    int required_len = add(len_a, len_b);
+    int n = transform_len(required_len, ctx->log_n, ctx->n, &log_n, &radix3);
+    ull mark = MARK(ctx);
+
+    memset(&ctx->fa[0][len_a], 0, fast_mul(fast_sub(n, len_a), sizeof(ll)));
+    memset(&fb[0][len_b], 0, fast_mul(fast_sub(n, len_b), sizeof(ll)));
+    memcpy(ctx->fa[1], ctx->fa[0], fast_mul(n, sizeof(ll)));
+    memcpy(fb[1], fb[0], fast_mul(n, sizeof(ll)));
+
+    // Forward transforms of a and b under both primes as one batch, so they run side by side
+    ntt_batch forward = { { ctx->fa[0], ctx->fa[1], fb[0], fb[1] }, { 0, 1, 0, 1 }, IS_NOT_ZERO(square) ? 2 : 4, log_n, radix3, 0 };
+    run_team(ctx, ntt_task, &forward, IS_GREATER_EQUAL(log_n, PARALLEL_LOG_N));
+    LAP(ctx, mark, forward);
+    finish_ntt(ctx, ctx->fa, fb, log_n, radix3, required_len, out);
+}
+
+// Same with a prepared operand as a: only b (loaded in fb[0]) is transformed
+static void multiply_ntt_prepared(bigmul_ctx* ctx, const bigmul_prepared* prep, int len_b, ll out[]) {
+    int n = 1 << prep->log_m;
+    if (IS_NOT_ZERO(prep->radix3)) { n = fast_mul(n, 3); }
+    ull mark = MARK(ctx);
+    memset(&ctx->fb[0][len_b], 0, fast_mul(fast_sub(n, len_b), sizeof(ll)));
+    memcpy(ctx->fb[1], ctx->fb[0], fast_mul(n, sizeof(ll)));
+
+    ntt_batch forward = { { ctx->fb[0], ctx->fb[1] }, { 0, 1 }, 2, prep->log_m, prep->radix3, 0 };
+    run_team(ctx, ntt_task, &forward, IS_GREATER_EQUAL(prep->log_m, PARALLEL_LOG_N));
+    LAP(ctx, mark, forward);
+    finish_ntt(ctx, prep->spectrum, ctx->fb, prep->log_m, prep->radix3, add(prep->len, len_b), out);
+}
+
+// Multiplies the limbs already loaded in fa[0] / fb[0] (fa[0] twice when squaring); the context
+// must be prepared for len_a + len_b. Small or lopsided products skip the transforms.
+// With prep set, a is the prepared operand instead of fa[0] (len_a = prep->len).
+static int multiply_convolution(bigmul_ctx* ctx, const bigmul_prepared* prep, int len_a, int len_b, int square,
+                                ll out[], size_t* out_len) {
+    ll* const* fb = IS_NOT_ZERO(square) ? ctx->fa : ctx->fb;
+    const ll* a = prep ? prep->limbs : ctx->fa[0];
+    int a_is_zero = 0;
+    if (IS_EQUAL(len_a, 1)) {
+        if (IS_EQUAL(a[0], 0)) {
+            a_is_zero = 1;
+        }
+    }
+    int b_is_zero = 0;
+    if (IS_EQUAL(len_b, 1)) {
+        if (IS_EQUAL(fb[0][0], 0)) {
+            b_is_zero = 1;
+        }
+    }
+    if (a_is_zero | b_is_zero) {
+        out[0] = 0;
+        *out_len = 1;
+        return BIGMUL_OK;
+    }
+
+    // Exact integer arithmetic below the NTT threshold, only the transforms are verified
+    ull expect[MAX_VERIFY];
+    int verify = 0;
+    if (FAST_LESS(len_a, NTT_THRESHOLD) | FAST_LESS(len_b, NTT_THRESHOLD)) {
+        int status = multiply_small(ctx, a, len_a, fb[0], len_b, out);
+        if (IS_NOT_ZERO(status)) { return status; }
+    } else {
+        ull mark = MARK(ctx);
+        verify = IS_NOT_ZERO(ctx->verify);
+        if (verify) { verify_expect(ctx, a, len_a, fb[0], len_b, expect); }
+        LAP(ctx, mark, verify);
+        if (prep) {
+            multiply_ntt_prepared(ctx, prep, len_b, out);
+        } else {
+            multiply_ntt(ctx, len_a, len_b, square, out);
+        }
+    }
+
+    int final_len = add(len_a, len_b);
+final_len_check:
+    if (IS_GREATER(final_len, 1)) {
+        if (IS_EQUAL(out[subtract(final_len, 1)], 0)) {
+            final_len = subtract(final_len, 1);
+            goto final_len_check;
+        }
+    }
+    if (verify) {
+        ull mark = MARK(ctx);
+        int status = verify_product(ctx, out, final_len, expect);
+        LAP(ctx, mark, verify);
+        if (IS_NOT_ZERO(status)) { return status; }
+    }
+    *out_len = final_len;
+    return BIGMUL_OK;
+}
+
+// Public API
+// ======================================================================
+size_t bigmul_limbs_for(size_t digits) { return add(digits, subtract(WIDTH, 1)) >> 2; }
+
+size_t bigmul_out_size(size_t la, size_t lb) { return add(add(la, lb), 1); }
+
+// Eight digits (s[0] most significant) into two limbs, -1 if any byte is not a digit.
+// Loads little-endian, so s[0] lands in the low byte.
+static int swar_read_8(const char* s, ll* hi, ll* lo) {
+    ull x, d;
+    memcpy(&x, s, 8);
+    d = x ^ SWAR_ZERO;
+    // high nibble must be 0, low nibble 8/9 at most (bit 3 set only without bits 2 and 1)
+    if (IS_NOT_ZERO((d & SWAR_HIGH_NIBBLES) | (d & ((d << 1) | (d << 2)) & SWAR_BIT3))) { return -1; }
+    d = fast_add(fast_mul(d, 10), d >> 8) & SWAR_BYTE_LANES;
+    d = fast_add(fast_mul(d, 100), d >> 16) & SWAR_PAIR_LANES;
+    *hi = d & 0xFFFF;
+    *lo = d >> 32;
+    return 0;
+}
+
+int bigmul_parse(const char* s, size_t len, bigmul_limb* out, size_t* out_len) {
+    if (IS_EQUAL(len, 0)) { return BIGMUL_ERR_INPUT; }
+
+    ll arr_idx = 0;
+    ll current_pos = len;
+swar_loop:
+    if (IS_GREATER_EQUAL(current_pos, 8)) {
+        current_pos = fast_sub(current_pos, 8);
+        if (IS_NOT_ZERO(swar_read_8(&s[current_pos], &out[fast_add(arr_idx, 1)], &out[arr_idx]))) {
+            return BIGMUL_ERR_INPUT;
+        }
+        arr_idx = fast_add(arr_idx, 2);
+        goto swar_loop;
+    }
+
+    // Fewer than 8 leading digits left
+    ll i = 0;
+check_loop:
+    if (IS_LESS(i, current_pos)) {
+        ll is_invalid_char = add(IS_LESS(s[i], '0'), IS_GREATER(s[i], '9'));
+
+        if (IS_NOT_ZERO(is_invalid_char)) {
+            return BIGMUL_ERR_INPUT;
+        }
+
+        i = add(i, 1);
+        goto check_loop;
+    }
+
+read_loop:
+    if (IS_GREATER(current_pos, 0)) {
+        ll chunk_start = subtract(current_pos, WIDTH);
+        if (IS_LESS(chunk_start, 0)) { chunk_start = 0; }
+
+        ll val = 0;
+        ll j = chunk_start;
+    chunk_loop:
+        if (IS_LESS(j, current_pos)) {
+            ll digit = subtract(s[j], '0');
+            val = add(mul(val, 10), digit);
+            j = add(j, 1);
+            goto chunk_loop;
+        }
+        out[arr_idx] = val;
+        arr_idx = add(arr_idx, 1);
+        current_pos = subtract(current_pos, WIDTH);
+        goto read_loop;
+    }
+
+trim_loop:
+    if (IS_GREATER(arr_idx, 1)) {
+        if (IS_EQUAL(out[subtract(arr_idx, 1)], 0)) {
+            arr_idx = subtract(arr_idx, 1);
+            goto trim_loop;
+        }
+    }
+    *out_len = arr_idx;
+    return BIGMUL_OK;
+}
+
+static const char digit_pairs[] =
+    "00010203040506070809101112131415161718192021222324252627282930313233343536373839404142434445464748495051525354555657585960616263646566676869707172737475767778798081828384858687888990919293949596979899";
+
+size_t bigmul_format(const bigmul_limb* limbs, size_t len, char* out) {
+    if (IS_EQUAL(len, 0)) { out[0] = '0'; out[1] = '\0'; return 1; }
+
+    ll pos = sprintf(out, "%lld", limbs[subtract(len, 1)]);
+    ll i = subtract(len, 2);
+print_loop:
+    if (IS_GREATER_EQUAL(i, 0)) {
+        // limb / 100 as a multiply-shift, exact below 43699
+        ll v = limbs[i], hi = fast_mul(v, 5243) >> 19, lo = fast_sub(v, fast_mul(hi, 100));
+        memcpy(&out[pos], &digit_pairs[hi << 1], 2);
+        memcpy(&out[fast_add(pos, 2)], &digit_pairs[lo << 1], 2);
+        pos = fast_add(pos, WIDTH);
+        i = fast_sub(i, 1);
+        goto print_loop;
+    }
+    out[pos] = '\0';
+    return pos;
+}
+
+int bigmul(bigmul_ctx* ctx, const char* a, size_t la, const char* b, size_t lb, char* out, size_t* out_len) {
+    size_t len_a, len_b, res_len;
+    int status = prepare(ctx, add(bigmul_limbs_for(la), bigmul_limbs_for(lb)));
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    // Same digits on both sides (or the same buffer): parse once and square
+    ull mark = MARK(ctx);
+    int square = IS_EQUAL(la, lb) && (a == b || IS_EQUAL(memcmp(a, b, la), 0));
+
+    status = bigmul_parse(a, la, ctx->fa[0], &len_a);
+    if (IS_NOT_ZERO(status)) { return status; }
+    len_b = len_a;
+    if (!square) {
+        status = bigmul_parse(b, lb, ctx->fb[0], &len_b);
+        if (IS_NOT_ZERO(status)) { return status; }
+    }
+    LAP(ctx, mark, parse);
+
+    status = multiply_convolution(ctx, NULL, len_a, len_b, square, ctx->res, &res_len);
+    if (IS_NOT_ZERO(status)) { return status; }
+    mark = MARK(ctx);
+    *out_len = bigmul_format(ctx->res, res_len, out);
+    LAP(ctx, mark, format);
+    return BIGMUL_OK;
+}
+
+// Nonzero if any of the len limbs is outside [0, BASE)
+static ull check_limbs(const bigmul_limb src[], size_t len) {
+    ull i = 0, invalid = 0;
+check_loop:
+    if (FAST_LESS(i, len)) {
+        invalid = invalid | ((ull)src[i] >> 63) | !FAST_LESS(src[i], BASE);
+        i = fast_add(i, 1);
+        goto check_loop;
+    }
+    return invalid;
+}
+
+// Copies len limbs into dst, nonzero if any of them is outside [0, BASE)
+static ull load_limbs(ll dst[], const bigmul_limb src[], size_t len) {
+    memcpy(dst, src, fast_mul(len, sizeof(ll)));
+    return check_limbs(src, len);
+}
+
+// Length without the leading zero limbs, at least 1
+static size_t trimmed_len(const bigmul_limb limbs[], size_t len) {
+trim_loop:
+    if (IS_GREATER(len, 1)) {
+        if (IS_EQUAL(limbs[subtract(len, 1)], 0)) { len = subtract(len, 1); goto trim_loop; }
+    }
+    return len;
+}
+
+int bigmul_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, const bigmul_limb* b, size_t lb,
+                 bigmul_limb* out, size_t* out_len) {
+    if (IS_EQUAL(la, 0) | IS_EQUAL(lb, 0)) { return BIGMUL_ERR_INPUT; }
+    int status = prepare(ctx, add(la, lb));
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    if (IS_NOT_ZERO(load_limbs(ctx->fa[0], a, la) | load_limbs(ctx->fb[0], b, lb))) { return BIGMUL_ERR_INPUT; }
+    la = trimmed_len(a, la);
+    lb = trimmed_len(b, lb);
+
+    int square = IS_EQUAL(la, lb) && (a == b || IS_EQUAL(memcmp(a, b, fast_mul(la, sizeof(bigmul_limb))), 0));
+    return multiply_convolution(ctx, NULL, la, lb, square, out, out_len);
+}
+
+int bigmul_square(bigmul_ctx* ctx, const char* a, size_t la, char* out, size_t* out_len) {
+    return bigmul(ctx, a, la, a, la, out, out_len);
+}
+
+int bigmul_square_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, bigmul_limb* out, size_t* out_len) {
+    return bigmul_limbs(ctx, a, la, a, la, out, out_len);
+}
+
+// Prepared operands
+// ======================================================================
+
+// Picks the transform for the operand already in prep->limbs and, when some partner can take
+// the NTT path, stores its forward transform under both primes
+static int prepare_operand(bigmul_ctx* ctx, bigmul_prepared* prep, size_t max_len) {
+    size_t required_len = add(prep->len, max_len);
+    if (IS_GREATER(required_len, 1 << MAX_LOG_N)) { return BIGMUL_ERR_SIZE; }
+    prep->max_len = max_len;
+    int n = transform_len(required_len, MAX_LOG_N, 1 << MAX_LOG_N, &prep->log_m, &prep->radix3);
+    if (FAST_LESS(prep->len, NTT_THRESHOLD) | FAST_LESS(max_len, NTT_THRESHOLD)) { return BIGMUL_OK; }
+
+    int status = prepare_transform(ctx, prep->log_m, prep->radix3);
+    if (IS_NOT_ZERO(status)) { return status; }
+    prep->spectrum[0] = malloc(fast_mul(n, sizeof(ll)));
+    prep->spectrum[1] = malloc(fast_mul(n, sizeof(ll)));
+    if (!prep->spectrum[0] || !prep->spectrum[1]) { return BIGMUL_ERR_NOMEM; }
+
+    memcpy(prep->spectrum[0], prep->limbs, fast_mul(prep->len, sizeof(ll)));
+    memset(&prep->spectrum[0][prep->len], 0, fast_mul(fast_sub(n, prep->len), sizeof(ll)));
+    memcpy(prep->spectrum[1], prep->spectrum[0], fast_mul(n, sizeof(ll)));
+    ntt_batch forward = { { prep->spectrum[0], prep->spectrum[1] }, { 0, 1 }, 2, prep->log_m, prep->radix3, 0 };
+    run_team(ctx, ntt_task, &forward, IS_GREATER_EQUAL(prep->log_m, PARALLEL_LOG_N));
+    return BIGMUL_OK;
+}
+
+int bigmul_prepare(bigmul_ctx* ctx, const char* a, size_t la, size_t max_digits, bigmul_prepared** out) {
+    bigmul_prepared* prep = calloc(1, sizeof(bigmul_prepared));
+    size_t len;
+    int status = BIGMUL_ERR_NOMEM;
+    *out = NULL;
+    if (prep) { prep->limbs = malloc(fast_mul(add(bigmul_limbs_for(la), 1), sizeof(ll))); }
+    if (prep && prep->limbs) {
+        status = bigmul_parse(a, la, prep->limbs, &len);
+        prep->len = len;
+    }
+    if (IS_EQUAL(status, BIGMUL_OK)) { status = prepare_operand(ctx, prep, bigmul_limbs_for(max_digits)); }
+    if (IS_NOT_ZERO(status)) { bigmul_prepared_destroy(prep); return status; }
+    *out = prep;
+    return BIGMUL_OK;
+}
+
+int bigmul_prepare_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, size_t max_limbs, bigmul_prepared** out) {
+    bigmul_prepared* prep;
+    int status = BIGMUL_ERR_INPUT;
+    *out = NULL;
+    if (IS_EQUAL(la, 0)) { return status; }
+    prep = calloc(1, sizeof(bigmul_prepared));
+    if (!prep || !(prep->limbs = malloc(fast_mul(la, sizeof(ll))))) {
+        status = BIGMUL_ERR_NOMEM;
+    } else if (!IS_NOT_ZERO(load_limbs(prep->limbs, a, la))) {
+        prep->len = trimmed_len(a, la);
+        status = prepare_operand(ctx, prep, max_limbs);
+    }
+    if (IS_NOT_ZERO(status)) { bigmul_prepared_destroy(prep); return status; }
+    *out = prep;
+    return BIGMUL_OK;
+}
+
+void bigmul_prepared_destroy(bigmul_prepared* prep) {
+    if (!prep) { return; }
+    free(prep->limbs);
+    free(prep->spectrum[0]);
+    free(prep->spectrum[1]);
+    free(prep);
+}
+
+int bigmul_prepared_mul(bigmul_ctx* ctx, const bigmul_prepared* a, const char* b, size_t lb, char* out, size_t* out_len) {
+    size_t len_b, res_len;
+    if (IS_GREATER(bigmul_limbs_for(lb), a->max_len)) { return BIGMUL_ERR_SIZE; }
+    int status = prepare_transform(ctx, a->log_m, a->radix3);
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    status = bigmul_parse(b, lb, ctx->fb[0], &len_b);
+    if (IS_NOT_ZERO(status)) { return status; }
+    status = multiply_convolution(ctx, a, a->len, len_b, 0, ctx->res, &res_len);
+    if (IS_NOT_ZERO(status)) { return status; }
+    *out_len = bigmul_format(ctx->res, res_len, out);
+    return BIGMUL_OK;
+}
+
+int bigmul_prepared_mul_limbs(bigmul_ctx* ctx, const bigmul_prepared* a, const bigmul_limb* b, size_t lb,
+                              bigmul_limb* out, size_t* out_len) {
+    if (IS_EQUAL(lb, 0)) { return BIGMUL_ERR_INPUT; }
+    lb = trimmed_len(b, lb);
+    if (IS_GREATER(lb, a->max_len)) { return BIGMUL_ERR_SIZE; }
+    int status = prepare_transform(ctx, a->log_m, a->radix3);
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    if (IS_NOT_ZERO(load_limbs(ctx->fb[0], b, lb))) { return BIGMUL_ERR_INPUT; }
+    return multiply_convolution(ctx, a, a->len, lb, 0, out, out_len);
+}
+
+// Powers and product trees
+// ======================================================================
+// Intermediate products stay in limbs and go straight back into the transform buffers.
+// mul_into copies both inputs into fa / fb before writing out, so out may overlap them and
+// every intermediate can live in the caller's output buffer.
+static int mul_into(bigmul_ctx* ctx, const ll x[], size_t lx, const ll y[], size_t ly, ll out[], size_t* out_len) {
+    int status = prepare(ctx, add(lx, ly));
+    if (IS_NOT_ZERO(status)) { return status; }
+    int square = (x == y) & IS_EQUAL(lx, ly);
+    memcpy(ctx->fa[0], x, fast_mul(lx, sizeof(ll)));
+    if (!square) { memcpy(ctx->fb[0], y, fast_mul(ly, sizeof(ll))); }
+    return multiply_convolution(ctx, NULL, lx, ly, square, out, out_len);
+}
+
+size_t bigmul_pow_limbs_for(size_t la, unsigned long long k) {
+    size_t bound;
+    if (IS_EQUAL(k, 0) || __builtin_mul_overflow(la, k, &bound)) { return 1; }
+    return bound;
+}
+
+// Left to right over the bits of k: square, then multiply by a where the bit is set.
+// With a^j in out the next step writes at most (2j + 1) * la <= k * la limbs.
+int bigmul_pow_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, unsigned long long k,
+                     bigmul_limb* out, size_t* out_len) {
+    size_t bound, len;
+    if (IS_EQUAL(la, 0) || IS_NOT_ZERO(check_limbs(a, la))) { return BIGMUL_ERR_INPUT; }
+    la = trimmed_len(a, la);
+    // a^0 = 1, 0^k = 0, 1^k = 1
+    if (IS_EQUAL(k, 0) | (IS_EQUAL(la, 1) & IS_LESS(a[0], 2))) {
+        out[0] = IS_EQUAL(k, 0) ? 1 : a[0];
+        *out_len = 1;
+        return BIGMUL_OK;
+    }
+    if (__builtin_mul_overflow(la, k, &bound)) { return BIGMUL_ERR_SIZE; }
+
+    memcpy(out, a, fast_mul(la, sizeof(ll)));
+    len = la;
+    int bit = fast_sub(63, __builtin_clzll(k)), status;
+bit_loop:
+    if (IS_GREATER(bit, 0)) {
+        bit = fast_sub(bit, 1);
+        status = mul_into(ctx, out, len, out, len, out, &len);
+        if (IS_NOT_ZERO(status)) { return status; }
+        if ((k >> bit) & 1) {
+            status = mul_into(ctx, out, len, a, la, out, &len);
+            if (IS_NOT_ZERO(status)) { return status; }
+        }
+        goto bit_loop;
+    }
+    *out_len = len;
+    return BIGMUL_OK;
+}
+
+// out = out * m + addend for m, addend < 2^32 (base BASE or 2^BINARY_BITS), returns the new length
+static size_t mul_small_add(ll out[], size_t len, ull m, ull addend, int binary) {
+    ull carry = addend;
+    size_t i = 0;
+limb_loop:
+    if (FAST_LESS(i, len)) {
+        carry = split_limb(fast_add(fast_mul(out[i], m), carry), binary, &out[i]);
+        i = fast_add(i, 1);
+        goto limb_loop;
+    }
+spill_loop:
+    if (IS_NOT_ZERO(carry)) {
+        carry = split_limb(carry, binary, &out[len]);
+        len = fast_add(len, 1);
+        goto spill_loop;
+    }
+    return len;
+}
+
+// lo * (lo + 1) * ... * hi into out one word at a time, returns the length
+static size_t range_product_small(ull lo, ull hi, ll out[]) {
+    size_t len = 1;
+    ull m = lo;
+    out[0] = 1;
+factor_loop:
+    if (!FAST_LESS(hi, m)) {
+        len = mul_small_add(out, len, m, 0, 0);
+        m = fast_add(m, 1);
+        goto factor_loop;
+    }
+    return len;
+}
+
+// Each half is built in place, the right one just past the left one's actual length, so a
+// range never takes more than the sum of its factors' limb counts
+static int range_product(bigmul_ctx* ctx, ull lo, ull hi, ll out[], size_t* out_len) {
+    if (FAST_LESS(fast_sub(hi, lo), PRODUCT_LEAF)) {
+        *out_len = range_product_small(lo, hi, out);
+        return BIGMUL_OK;
+    }
+    ull mid = fast_add(lo, fast_sub(hi, lo) >> 1);
+    size_t left, right;
+    int status = range_product(ctx, lo, mid, out, &left);
+    if (IS_NOT_ZERO(status)) { return status; }
+    status = range_product(ctx, fast_add(mid, 1), hi, &out[left], &right);
+    if (IS_NOT_ZERO(status)) { return status; }
+    return mul_into(ctx, out, left, &out[left], right, out, out_len);
+}
+
+// n factors of at most limbs(n) limbs each
+size_t bigmul_factorial_limbs_for(unsigned long long n) {
+    size_t limbs = 0;
+    ull rest = n;
+    if (IS_LESS(n, 2) | IS_GREATER(n, 1 << MAX_LOG_N)) { return 1; }
+limb_loop:
+    if (IS_NOT_ZERO(rest)) {
+        rest = div_base(rest);
+        limbs = fast_add(limbs, 1);
+        goto limb_loop;
+    }
+    return fast_mul(n, limbs);
+}
+
+int bigmul_factorial_limbs(bigmul_ctx* ctx, unsigned long long n, bigmul_limb* out, size_t* out_len) {
+    // 2^MAX_LOG_N! is far past the largest transform, and the bound keeps word products in range
+    if (IS_GREATER(n, 1 << MAX_LOG_N)) { return BIGMUL_ERR_SIZE; }
+    if (IS_LESS(n, 2)) { out[0] = 1; *out_len = 1; return BIGMUL_OK; }
+    return range_product(ctx, 2, n, out, out_len);
+}
+
+static int tree_product(bigmul_ctx* ctx, const bigmul_limb* const xs[], const size_t lens[], size_t count,
+                        ll out[], size_t* out_len) {
+    if (IS_EQUAL(count, 1)) {
+        memcpy(out, xs[0], fast_mul(lens[0], sizeof(ll)));
+        *out_len = trimmed_len(xs[0], lens[0]);
+        return BIGMUL_OK;
+    }
+    size_t half = count >> 1, left, right;
+    int status = tree_product(ctx, xs, lens, half, out, &left);
+    if (IS_NOT_ZERO(status)) { return status; }
+    status = tree_product(ctx, &xs[half], &lens[half], fast_sub(count, half), &out[left], &right);
+    if (IS_NOT_ZERO(status)) { return status; }
+    return mul_into(ctx, out, left, &out[left], right, out, out_len);
+}
+
+int bigmul_product_limbs(bigmul_ctx* ctx, const bigmul_limb* const* xs, const size_t* lens, size_t count,
+                         bigmul_limb* out, size_t* out_len) {
+    size_t i = 0;
+check_loop:
+    if (FAST_LESS(i, count)) {
+        if (IS_EQUAL(lens[i], 0) || IS_NOT_ZERO(check_limbs(xs[i], lens[i]))) { return BIGMUL_ERR_INPUT; }
+        i = fast_add(i, 1);
+        goto check_loop;
+    }
+    if (IS_EQUAL(count, 0)) { out[0] = 1; *out_len = 1; return BIGMUL_OK; }
+    return tree_product(ctx, xs, lens, count, out, out_len);
+}
+
+// Binary words
+// ======================================================================
+// Conversions split the source at k = 2^j digits: x = hi * S^k + lo, with S^k taken from a
+// table of repeated squares in the target radix, so the work is a few products per level.
+// Binary values are 2^BINARY_BITS digits inside, packed two to a word at the edges.
+typedef struct {
+    int binary;                   // target radix 2^BINARY_BITS (from decimal) or BASE (to decimal)
+    ull source_radix;
+    ll* powers[64];               // powers[j] = source_radix^(2^j) in the target radix
+    size_t power_len[64];
+} radix_job;
+
+// src (n source digits) into dst in the target radix, trimmed length in *out_len.
+// Every target digit count is at most twice the source one, so dst takes 2n digits and tmp 4n:
+// lo is kept in tmp while hi is converted into dst, hi * S^k is formed in place and lo added.
+static int convert_digits(bigmul_ctx* ctx, const radix_job* job, const ll src[], size_t n, ll dst[], ll tmp[],
+                          size_t* out_len) {
+    size_t len = 1, lo_len, i;
+    if (!IS_GREATER(n, CONVERT_LEAF)) {
+        dst[0] = 0;
+        i = n;
+    horner_loop:
+        if (IS_NOT_ZERO(i)) {
+            i = fast_sub(i, 1);
+            len = mul_small_add(dst, len, job->source_radix, src[i], job->binary);
+            goto horner_loop;
+        }
+        *out_len = trimmed_len(dst, len);
+        return BIGMUL_OK;
+    }
+
+    int j = fast_sub(63, __builtin_clzll(fast_sub(n, 1)));
+    size_t k = (size_t)1 << j;
+    int status = convert_digits(ctx, job, src, k, tmp, &tmp[k << 1], &lo_len);
+    if (IS_NOT_ZERO(status)) { return status; }
+    status = convert_digits(ctx, job, &src[k], fast_sub(n, k), dst, &tmp[k << 1], &len);
+    if (IS_NOT_ZERO(status)) { return status; }
+    status = mul_into(ctx, dst, len, job->powers[j], job->power_len[j], dst, &len);
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    // lo < S^k <= hi * S^k, so the sum never outgrows the product's untrimmed length
+    ull carry = 0;
+    i = 0;
+add_loop:
+    if (FAST_LESS(i, lo_len) | IS_NOT_ZERO(carry)) {
+        ull addend = FAST_LESS(i, lo_len) ? tmp[i] : 0;
+        carry = split_limb(fast_add(fast_add(dst[i], addend), carry), job->binary, &dst[i]);
+        i = fast_add(i, 1);
+        goto add_loop;
+    }
+    if (FAST_LESS(len, i)) { len = i; }
+    *out_len = trimmed_len(dst, len);
+    return BIGMUL_OK;
+}
+
+// Whole conversion of src (n >= 1 digits) into dst (2n digits)
+static int convert_radix(bigmul_ctx* ctx, int binary, const ll src[], size_t n, ll dst[], size_t* out_len) {
+    radix_job job;
+    int top = 0, j = 0, status = BIGMUL_OK;
+    // The widest split is at the top power of two below n
+    if (IS_GREATER(n, CONVERT_LEAF)) { top = fast_sub(63, __builtin_clzll(fast_sub(n, 1))); }
+    // Slot j holds 4 * 2^j digits: the square of slot j - 1 before trimming
+    ll* tmp = malloc(fast_mul(fast_add(n << 2, 1), sizeof(ll)));
+    ll* powers = malloc(fast_mul((size_t)8 << top, sizeof(ll)));
+    if (!tmp || !powers) { free(tmp); free(powers); return BIGMUL_ERR_NOMEM; }
+
+    job.binary = binary;
+    job.source_radix = IS_NOT_ZERO(binary) ? BASE : BINARY_RADIX;
+    job.powers[0] = powers;
+    powers[0] = 0;
+    job.power_len[0] = mul_small_add(powers, 1, 0, job.source_radix, binary);
+    ctx->binary = binary;
+power_loop:
+    if (IS_LESS(j, top) & IS_EQUAL(status, BIGMUL_OK)) {
+        j = fast_add(j, 1);
+        job.powers[j] = &job.powers[fast_sub(j, 1)][(size_t)4 << fast_sub(j, 1)];
+        status = mul_into(ctx, job.powers[fast_sub(j, 1)], job.power_len[fast_sub(j, 1)],
+                          job.powers[fast_sub(j, 1)], job.power_len[fast_sub(j, 1)], job.powers[j], &job.power_len[j]);
+        goto power_loop;
+    }
+    if (IS_EQUAL(status, BIGMUL_OK)) { status = convert_digits(ctx, &job, src, n, dst, tmp, out_len); }
+    ctx->binary = 0;
+    free(tmp);
+    free(powers);
+    return status;
+}
+
+// Words <-> 16-bit digits, both trimmed
+static size_t unpack_words(const bigmul_word w[], size_t len, ll out[]) {
+    size_t i = 0;
+unpack_loop:
+    if (FAST_LESS(i, len)) {
+        out[i << 1] = w[i] & BINARY_MASK;
+        out[fast_add(i << 1, 1)] = w[i] >> BINARY_BITS;
+        i = fast_add(i, 1);
+        goto unpack_loop;
+    }
+    return trimmed_len(out, len << 1);
+}
+
+static size_t pack_words(const ll digits[], size_t len, bigmul_word out[]) {
+    size_t i = 0, words = fast_add(len, 1) >> 1;
+pack_loop:
+    if (FAST_LESS(i, words)) {
+        size_t hi = fast_add(i << 1, 1);
+        out[i] = digits[i << 1] | (FAST_LESS(hi, len) ? (bigmul_word)digits[hi] << BINARY_BITS : 0);
+        i = fast_add(i, 1);
+        goto pack_loop;
+    }
+    return words;
+}
+
+// digits * log2(10) / 32 < digits * 107 / 1024
+size_t bigmul_words_for(size_t digits) { return add(fast_mul(digits, 107) >> 10, 1); }
+
+// 32 * log10(2) < 10 digits per word
+size_t bigmul_digits_for(size_t words) { return add(fast_mul(words, 10), 1); }
+
+int bigmul_from_decimal(bigmul_ctx* ctx, const char* s, size_t len, bigmul_word* out, size_t* out_len) {
+    size_t limbs_len, digits_len;
+    ll* limbs = malloc(fast_mul(add(bigmul_limbs_for(len), 1), sizeof(ll)));
+    ll* digits = malloc(fast_mul(add(bigmul_limbs_for(len), 1) << 1, sizeof(ll)));
+    int status = BIGMUL_ERR_NOMEM;
+    if (limbs && digits) { status = bigmul_parse(s, len, limbs, &limbs_len); }
+    if (IS_EQUAL(status, BIGMUL_OK)) { status = convert_radix(ctx, 1, limbs, limbs_len, digits, &digits_len); }
+    if (IS_EQUAL(status, BIGMUL_OK)) { *out_len = pack_words(digits, digits_len, out); }
+    free(limbs);
+    free(digits);
+    return status;
+}
+
+int bigmul_to_decimal(bigmul_ctx* ctx, const bigmul_word* w, size_t len, char* out, size_t* out_len) {
+    if (IS_EQUAL(len, 0)) { return BIGMUL_ERR_INPUT; }
+    size_t digits_len, limbs_len;
+    ll* digits = malloc(fast_mul(len << 1, sizeof(ll)));
+    ll* limbs = malloc(fast_mul(len << 2, sizeof(ll)));
+    int status = BIGMUL_ERR_NOMEM;
+    if (digits && limbs) {
+        digits_len = unpack_words(w, len, digits);
+        status = convert_radix(ctx, 0, digits, digits_len, limbs, &limbs_len);
+    }
+    if (IS_EQUAL(status, BIGMUL_OK)) { *out_len = bigmul_format(limbs, limbs_len, out); }
+    free(digits);
+    free(limbs);
+    return status;
+}
+
+int bigmul_words(bigmul_ctx* ctx, const bigmul_word* a, size_t la, const bigmul_word* b, size_t lb,
+                 bigmul_word* out, size_t* out_len) {
+    if (IS_EQUAL(la, 0) | IS_EQUAL(lb, 0)) { return BIGMUL_ERR_INPUT; }
+    int status = prepare(ctx, add(la, lb) << 1);
+    if (IS_NOT_ZERO(status)) { return status; }
+
+    size_t len_a = unpack_words(a, la, ctx->fa[0]), len_b = len_a, res_len;
+    int square = IS_EQUAL(la, lb) && (a == b || IS_EQUAL(memcmp(a, b, fast_mul(la, sizeof(bigmul_word))), 0));
+    if (!square) { len_b = unpack_words(b, lb, ctx->fb[0]); }
+    ctx->binary = 1;
+    status = multiply_convolution(ctx, NULL, len_a, len_b, square, ctx->res, &res_len);
+    ctx->binary = 0;
+    if (IS_NOT_ZERO(status)) { return status; }
+    *out_len = pack_words(ctx->res, res_len, out);
+    return BIGMUL_OK;
+}
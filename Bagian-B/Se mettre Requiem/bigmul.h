@@ -0,0 +1,135 @@
+/*
+ * File      : bigmul.h
+ * Author    : Nayekah
+ * Date      : 2025-08-01
+ * Modified  : Split out of multiply.c as a reusable library (libbigmul).
+ *             Squaring entry points.
+ *             Thread count per context.
+ *             Prepared operands for repeated products by the same factor.
+ *             Powers, factorials and multi-operand products.
+ *             Binary words: radix conversion and binary products.
+ *             Per-phase timing.
+ *             Product verification modulo random primes.
+ */
+
+#ifndef BIGMUL_H
+#define BIGMUL_H
+
+#include <stddef.h>
+#include <stdint.h>
+
+// Limbs are little-endian base 10^4 digits, the same layout multiply.c always used
+#define BIGMUL_BASE 10000
+#define BIGMUL_WIDTH 4
+
+// Status codes
+#define BIGMUL_OK 0
+#define BIGMUL_ERR_INPUT -1
+#define BIGMUL_ERR_SIZE -2
+#define BIGMUL_ERR_NOMEM -3
+#define BIGMUL_ERR_VERIFY -4    // the product failed its check (bigmul_set_verify), out is garbage
+
+typedef long long bigmul_limb;
+typedef uint32_t bigmul_word;
+typedef struct bigmul_ctx bigmul_ctx;
+typedef struct bigmul_prepared bigmul_prepared;
+
+// Context
+// ======================================================================
+// Holds the bit-reversal table, twiddles and NTT scratch. Prepared for products of up to
+// max_digits digits (0 = lazily), grown on demand. A context is used by one caller at a time.
+bigmul_ctx* bigmul_create(size_t max_digits);
+void bigmul_destroy(bigmul_ctx* ctx);
+// Team size for large products (2^15+ point transforms), the caller included. 0 = online CPUs,
+// 1 = single-threaded (the default). Returns the size actually started. Link with -pthread.
+int bigmul_set_threads(bigmul_ctx* ctx, int threads);
+
+// Nanoseconds per phase, added up over every call made while attached (the caller zeroes it).
+// Products below the NTT threshold land in `small` only.
+typedef struct {
+    unsigned long long parse;     // decimal -> limbs
+    unsigned long long forward;   // padding and forward transforms
+    unsigned long long pointwise;
+    unsigned long long inverse;
+    unsigned long long carry;     // CRT and carry normalization
+    unsigned long long small;     // schoolbook / Karatsuba / Toom-3, carries included
+    unsigned long long format;    // limbs -> decimal
+    unsigned long long verify;    // residues for bigmul_set_verify
+} bigmul_stats;
+// NULL detaches. Costs a clock read per phase while attached.
+void bigmul_set_stats(bigmul_ctx* ctx, bigmul_stats* stats);
+// Checks every NTT product modulo `checks` random 61-bit primes (at most 4, 0 = off, the default),
+// drawn afresh on every call. O(n) per check, around 1% of a 10^6-digit product. Returns the count set.
+int bigmul_set_verify(bigmul_ctx* ctx, int checks);
+
+// Buffer sizing
+// ======================================================================
+size_t bigmul_limbs_for(size_t digits);          // limbs needed for a `digits`-digit number
+size_t bigmul_out_size(size_t la, size_t lb);    // chars (with '\0') for the product of la and lb digits
+
+// Decimal <-> limbs
+// ======================================================================
+// Parses len decimal digits into limbs, leading zero limbs trimmed. BIGMUL_ERR_INPUT on non-digits.
+int bigmul_parse(const char* s, size_t len, bigmul_limb* out, size_t* out_len);
+// Writes the decimal form plus '\0' into out (4 * len + 1 chars is always enough), returns its length.
+size_t bigmul_format(const bigmul_limb* limbs, size_t len, char* out);
+
+// Products (caller-owned output buffers)
+// ======================================================================
+// out must hold bigmul_out_size(la, lb) chars; *out_len receives the digit count.
+int bigmul(bigmul_ctx* ctx, const char* a, size_t la, const char* b, size_t lb, char* out, size_t* out_len);
+// out must hold la + lb limbs; *out_len receives the trimmed limb count.
+int bigmul_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, const bigmul_limb* b, size_t lb,
+                 bigmul_limb* out, size_t* out_len);
+
+// a * a with one forward transform instead of two. bigmul / bigmul_limbs take this path
+// by themselves when both operands are equal, these just skip the comparison.
+int bigmul_square(bigmul_ctx* ctx, const char* a, size_t la, char* out, size_t* out_len);
+int bigmul_square_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, bigmul_limb* out, size_t* out_len);
+
+// Prepared operands
+// ======================================================================
+// Keeps the forward transform of a fixed factor, so a product against it transforms only the
+// other side: two transforms instead of three. Partners may have up to max_digits digits
+// (max_limbs limbs), the transform size is picked for that. Once built the operand is
+// read-only and may be shared by any number of contexts. *out is NULL on failure.
+int bigmul_prepare(bigmul_ctx* ctx, const char* a, size_t la, size_t max_digits, bigmul_prepared** out);
+int bigmul_prepare_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, size_t max_limbs, bigmul_prepared** out);
+void bigmul_prepared_destroy(bigmul_prepared* prep);
+
+// bigmul / bigmul_limbs with a prepared first factor (out sized for its digit / limb count as usual).
+// BIGMUL_ERR_SIZE when b is longer than a was prepared for.
+int bigmul_prepared_mul(bigmul_ctx* ctx, const bigmul_prepared* a, const char* b, size_t lb, char* out, size_t* out_len);
+int bigmul_prepared_mul_limbs(bigmul_ctx* ctx, const bigmul_prepared* a, const bigmul_limb* b, size_t lb,
+                              bigmul_limb* out, size_t* out_len);
+
+// Powers and product trees
+// ======================================================================
+// Limbs in and out; intermediates never go back to decimal and are built inside out itself.
+// a^k by squaring, out must hold bigmul_pow_limbs_for(la, k) limbs (la * k, 1 for k = 0).
+size_t bigmul_pow_limbs_for(size_t la, unsigned long long k);
+int bigmul_pow_limbs(bigmul_ctx* ctx, const bigmul_limb* a, size_t la, unsigned long long k,
+                     bigmul_limb* out, size_t* out_len);
+// n! as a balanced product tree, out must hold bigmul_factorial_limbs_for(n) limbs.
+// BIGMUL_ERR_SIZE past n = 2^23, long before which the product outgrows the transforms anyway.
+size_t bigmul_factorial_limbs_for(unsigned long long n);
+int bigmul_factorial_limbs(bigmul_ctx* ctx, unsigned long long n, bigmul_limb* out, size_t* out_len);
+// xs[0] * ... * xs[count - 1] as a balanced product tree, out must hold the sum of lens (at least 1).
+int bigmul_product_limbs(bigmul_ctx* ctx, const bigmul_limb* const* xs, const size_t* lens, size_t count,
+                         bigmul_limb* out, size_t* out_len);
+
+// Binary words
+// ======================================================================
+// Little-endian 2^32 words, so callers can keep numbers in binary and only touch decimal at the
+// edges. Conversions are divide-and-conquer on the same multiplier, subquadratic both ways.
+size_t bigmul_words_for(size_t digits);          // words needed for a `digits`-digit number
+size_t bigmul_digits_for(size_t words);          // chars (with '\0') for the decimal form of `words` words
+// Trimmed words in out (bigmul_words_for(len) of them). BIGMUL_ERR_INPUT on non-digits.
+int bigmul_from_decimal(bigmul_ctx* ctx, const char* s, size_t len, bigmul_word* out, size_t* out_len);
+// Decimal form plus '\0' in out (bigmul_digits_for(len) chars), *out_len receives its length.
+int bigmul_to_decimal(bigmul_ctx* ctx, const bigmul_word* w, size_t len, char* out, size_t* out_len);
+// Binary product, out must hold la + lb words; *out_len receives the trimmed word count.
+int bigmul_words(bigmul_ctx* ctx, const bigmul_word* a, size_t la, const bigmul_word* b, size_t lb,
+                 bigmul_word* out, size_t* out_len);
+
+#endif // BIGMUL_H
@@ -4,287 +4,454 @@
  * Author    : Nayekah
  * Date      : 2025-08-01
  * Modified  : To include input validation.
+ *             NTT engine moved to bigmul.c (libbigmul), this is the CLI front end.
+ *             File mode: ./multiply a.txt b.txt [result.txt] maps the operands with mmap.
+ *             Uses every online CPU, BIGMUL_THREADS overrides the count.
+ *             Batch mode: ./multiply --batch [in [out]] streams length-prefixed pairs through a worker pool.
+ *             BIGMUL_VERIFY=n checks every large product modulo n random primes.
  */
 
+#define _POSIX_C_SOURCE 200809L
+
 // Includes
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "bigmul.h"
 // #include <time.h>
 
 // MACROS AND CONSTANTS
-#define ll long long
-#define MOD 998244353
-#define ROOT 3
-#define MAX_N 524288
 #define MAX_LEN 1000005
-#define BASE 10000
-#define WIDTH 4
-#define MOD_MINUS_1 998244352
-#define MOD_MINUS_2 998244351
+#define MAX_LIMBS 250002
+#define MAX_RESULT_LIMBS 500004
+#define MAX_RESULT_LEN 2000011
+#define BATCH_WINDOW 256
 
 // logic bitwise
 #define IS_EQUAL(a, b) (!((a) ^ (b)))
 #define IS_NOT_ZERO(a) (!!(a))
-#define IS_LESS(a, b) (((subtract((a), (b))) >> 63) & 1)
-#define IS_GREATER(a, b) IS_LESS(b, a)
-#define IS_GREATER_EQUAL(a, b) (!IS_LESS(a, b))
-
-// Arithmetic and mod operations
-ll add(ll a, ll b) { ll carry; add_loop: if (!!b) { carry = a & b; a = a ^ b; b = carry << 1; goto add_loop; } return a; }
-ll subtract(ll a, ll b) { ll borrow; sub_loop: if (!!b) { borrow = (~a) & b; a = a ^ b; b = borrow << 1; goto sub_loop; } return a; }
-ll mod_add(ll a, ll b) { ll res = add(a, b); if (IS_GREATER_EQUAL(res, MOD)) { res = subtract(res, MOD); } return res; }
-ll mod_sub(ll a, ll b) { ll res = subtract(a, b); if (IS_LESS(res, 0)) { res = add(res, MOD); } return res; }
-ll mod_mul(ll a, ll b) { ll res = 0; mul_loop: if (IS_GREATER(b, 0)) { if (b & 1) { res = mod_add(res, a); } a = mod_add(a, a); b = b >> 1; goto mul_loop; } return res; }
-ll power(ll base, ll exp) { ll res = 1; pow_loop: if (IS_GREATER(exp, 0)) { if (exp & 1) { res = mod_mul(res, base); } base = mod_mul(base, base); exp = exp >> 1; goto pow_loop; } return res; }
-ll modInverse(ll n) { return power(n, MOD_MINUS_2); }
-
-// NTTs
-// ======================================================================
-static ll ntt_a[MAX_N], ntt_b[MAX_N];
-static int rev[MAX_N];
-
-void ntt(ll a[], int n, int invert) {
-    int i = 0;
-bit_rev_loop:
-    if (IS_LESS(i, n)) {
-        if (IS_LESS(i, rev[i])) { ll temp = a[i]; a[i] = a[rev[i]]; a[rev[i]] = temp; }
-        i = add(i, 1);
-        goto bit_rev_loop;
-    }
-    int len = 2, log_len = 1;
-len_loop:
-    if (IS_GREATER_EQUAL(n, len)) {
-        ll wlen = power(ROOT, MOD_MINUS_1 >> log_len);
-        if (IS_NOT_ZERO(invert)) { wlen = modInverse(wlen); }
-        int j = 0;
-    j_loop:
-        if (IS_LESS(j, n)) {
-            ll w = 1;
-            int k = 0, half_len = len >> 1;
-        k_loop:
-            if (IS_LESS(k, half_len)) {
-                int pos1 = add(j, k), pos2 = add(pos1, half_len);
-                ll u = a[pos1], v = mod_mul(a[pos2], w);
-                a[pos1] = mod_add(u, v);
-                a[pos2] = mod_sub(u, v);
-                w = mod_mul(w, wlen);
-                k = add(k, 1);
-                goto k_loop;
-            }
-            j = add(j, len);
-            goto j_loop;
-        }
-        len = len << 1;
-        log_len = add(log_len, 1);
-        goto len_loop;
-    }
-    if (IS_NOT_ZERO(invert)) {
-        ll n_inv = modInverse(n);
-        i = 0;
-    scale_loop:
-        if (IS_LESS(i, n)) { a[i] = mod_mul(a[i], n_inv); i = add(i, 1); goto scale_loop; }
-    }
-}
+#define IS_SPACE(c) (IS_EQUAL(c, '\n') | IS_EQUAL(c, '\r') | IS_EQUAL(c, ' ') | IS_EQUAL(c, '\t'))
+
+size_t subtract(size_t a, size_t b) { size_t borrow; sub_loop: if (!!b) { borrow = (~a) & b; a = a ^ b; b = borrow << 1; goto sub_loop; } return a; }
 
-// Main multiplication logic
-// ======================================================================
-static ll result[MAX_N];
 static char input_str[MAX_LEN];
+static bigmul_limb limbs_a[MAX_LIMBS], limbs_b[MAX_LIMBS];
+static bigmul_limb result[MAX_RESULT_LIMBS];
+static char result_str[MAX_RESULT_LEN];
 
-int read_to_base(ll arr[], const char* prompt) {
+int read_to_base(bigmul_limb arr[], const char* prompt) {
+    size_t len = 0;
     printf("%s", prompt);
-    scanf("%s", input_str);
+    input_str[0] = '\0';
+    scanf("%1000004s", input_str);
 
-    int i = 0;
-check_loop:
-    if (input_str[i] != '\0') {
-        ll is_invalid_char = add(IS_LESS(input_str[i], '0'), IS_GREATER(input_str[i], '9'));
-
-        if (IS_NOT_ZERO(is_invalid_char)) {
-            printf("\nError: Invalid input.\n");
-            printf("Only positive integers are allowed.\n");
-            return -1;
-        }
-        
-        i = add(i, 1);
-        goto check_loop;
+    if (IS_NOT_ZERO(bigmul_parse(input_str, strlen(input_str), arr, &len))) {
+        printf("\nError: Invalid input.\n");
+        printf("Only positive integers are allowed.\n");
+        return -1;
     }
+    return (int)len;
+}
 
-    int len = i;
+// The whole number is formatted into result_str first and written with a single fwrite
+void print_from_base(bigmul_limb arr[], int len) {
+    size_t out_len = bigmul_format(arr, len, result_str);
+    fputs("Result: ", stdout);
+    fwrite(result_str, 1, out_len, stdout);
+    putchar('\n');
+}
 
-    int arr_idx = 0;
-    int current_pos = len;
-read_loop:
-    if (IS_GREATER(current_pos, 0)) {
-        int chunk_start = subtract(current_pos, WIDTH);
-        if (IS_LESS(chunk_start, 0)) { chunk_start = 0; }
-        
-        ll val = 0;
-        int j = chunk_start;
-    chunk_loop:
-        if (IS_LESS(j, current_pos)) {
-            ll digit = subtract(input_str[j], '0');
-            val = add(mod_mul(val, 10), digit);
-            j = add(j, 1);
-            goto chunk_loop;
-        }
-        arr[arr_idx] = val;
-        arr_idx = add(arr_idx, 1);
-        current_pos = subtract(current_pos, WIDTH);
-        goto read_loop;
-    }
-    return arr_idx;
+// BIGMUL_THREADS=n, unset or 0 means every online CPU
+static int thread_count(void) {
+    const char* threads = getenv("BIGMUL_THREADS");
+    int n = threads ? atoi(threads) : 0;
+    if (!IS_NOT_ZERO(n)) { n = sysconf(_SC_NPROCESSORS_ONLN); }
+    return IS_EQUAL(n >> 31, 0) && IS_NOT_ZERO(n) ? n : 1;
 }
 
-void print_from_base(ll arr[], int len) {
-    printf("Result: ");
-    printf("%lld", arr[subtract(len, 1)]);
-    int i = subtract(len, 2);
-print_loop:
-    if (IS_GREATER_EQUAL(i, 0)) {
-        //printf("%0*lld", WIDTH, arr[i]);
-        
-        if (IS_LESS(arr[i], 1000)) {
-            printf("0");
-        }
-        if (IS_LESS(arr[i], 100)) {
-            printf("0");
-        }
-        if (IS_LESS(arr[i], 10)) {
-            printf("0");
-        }
+// BIGMUL_VERIFY=n, unset means no checks
+static void set_verify(bigmul_ctx* ctx) {
+    const char* checks = getenv("BIGMUL_VERIFY");
+    if (ctx && checks) { bigmul_set_verify(ctx, atoi(checks)); }
+}
 
-        printf("%lld", arr[i]);
-        
-        i = subtract(i, 1);
-        goto print_loop;
-    }
-    printf("\n");
+static bigmul_ctx* create_ctx(void) {
+    bigmul_ctx* ctx = bigmul_create(0);
+    if (ctx) { bigmul_set_threads(ctx, thread_count()); }
+    set_verify(ctx);
+    return ctx;
 }
 
 void multiply_convolution() {
     printf("zxcvbn calculator :3\n");
     printf("up to 10^1000000 integer size\n\n");
-    
-    int len_a = read_to_base(ntt_a, "a: ");
+
+    int len_a = read_to_base(limbs_a, "a: ");
 
     if (IS_EQUAL(len_a, -1)) {
         return;
     }
 
-    int len_b = read_to_base(ntt_b, "b: ");
+    int len_b = read_to_base(limbs_b, "b: ");
 
     if (IS_EQUAL(len_b, -1)) {
         return;
     }
-    
+
     printf("\nComputing multiplication (a * b)...\n");
 
-    int a_is_zero = 0;
-    if (IS_EQUAL(len_a, 1)) {
-        if (IS_EQUAL(ntt_a[0], 0)) {
-            a_is_zero = 1;
-        }
-    }
-    if (a_is_zero) {
-        printf("Result: 0\n");
+    bigmul_ctx* ctx = create_ctx();
+    size_t final_len = 0;
+    int status = ctx ? bigmul_limbs(ctx, limbs_a, len_a, limbs_b, len_b, result, &final_len) : BIGMUL_ERR_NOMEM;
+    bigmul_destroy(ctx);
+
+    if (IS_NOT_ZERO(status)) {
+        printf("Error: Multiplication failed (%d).\n", status);
         return;
     }
 
-    int b_is_zero = 0;
-    if (IS_EQUAL(len_b, 1)) {
-        if (IS_EQUAL(ntt_b[0], 0)) {
-            b_is_zero = 1;
-        }
+    print_from_base(result, final_len);
+}
+
+// File mode
+// ======================================================================
+typedef struct {
+    int fd;
+    char* data;
+    size_t len;                   // bytes to parse, trailing whitespace trimmed
+    size_t mapped;                // bytes mapped, what munmap needs
+} mapped_file;
+
+static int map_input(const char* path, mapped_file* f) {
+    struct stat st;
+    f->fd = open(path, O_RDONLY);
+    if (IS_EQUAL(f->fd, -1)) { return -1; }
+    if (IS_NOT_ZERO(fstat(f->fd, &st)) || IS_EQUAL(st.st_size, 0)) { close(f->fd); return -1; }
+
+    f->len = st.st_size;
+    f->mapped = f->len;
+    f->data = mmap(NULL, f->mapped, PROT_READ, MAP_PRIVATE, f->fd, 0);
+    if (f->data == MAP_FAILED) { close(f->fd); return -1; }
+    posix_madvise(f->data, f->len, POSIX_MADV_SEQUENTIAL);
+
+    // Trailing newline from editors and shell redirects is not part of the number
+trim_loop:
+    if (IS_NOT_ZERO(f->len)) {
+        if (IS_SPACE(f->data[subtract(f->len, 1)])) { f->len = subtract(f->len, 1); goto trim_loop; }
     }
-    if (b_is_zero) {
-        printf("Result: 0\n");
-        return;
+    return 0;
+}
+
+// Sized for the worst case up front, truncated to the real length once the product is written
+static int map_output(const char* path, size_t cap, mapped_file* f) {
+    f->fd = open(path, O_RDWR | O_CREAT | O_TRUNC, 0644);
+    if (IS_EQUAL(f->fd, -1)) { return -1; }
+    if (IS_NOT_ZERO(ftruncate(f->fd, cap))) { close(f->fd); return -1; }
+
+    f->len = cap;
+    f->mapped = cap;
+    f->data = mmap(NULL, f->mapped, PROT_READ | PROT_WRITE, MAP_SHARED, f->fd, 0);
+    if (f->data == MAP_FAILED) { close(f->fd); return -1; }
+    return 0;
+}
+
+static void unmap_file(mapped_file* f) {
+    munmap(f->data, f->mapped);
+    close(f->fd);
+}
+
+int multiply_files(const char* path_a, const char* path_b, const char* path_out) {
+    mapped_file in_a, in_b, out_file = { -1, NULL, 0, 0 };
+    int status = BIGMUL_ERR_NOMEM, exit_code = 1;
+    size_t out_len = 0;
+    char* out = NULL;
+    bigmul_ctx* ctx = NULL;
+
+    if (IS_NOT_ZERO(map_input(path_a, &in_a))) {
+        fprintf(stderr, "Error: Cannot read %s\n", path_a);
+        return 1;
     }
-    
-    int n = 1;
-    int required_len = add(len_a, len_b);
-n_size_loop:
-    if (IS_LESS(n, required_len)) { n = n << 1; goto n_size_loop; }
-    
-    int i = len_a;
-pad_a_loop:
-    if (IS_LESS(i, n)) { ntt_a[i] = 0; i = add(i, 1); goto pad_a_loop; }
-    i = len_b;
-pad_b_loop:
-    if (IS_LESS(i, n)) { ntt_b[i] = 0; i = add(i, 1); goto pad_b_loop; }
-
-    rev[0] = 0;
-    i = 1;
-precompute_rev_loop:
-    if (IS_LESS(i, n)) {
-        ll term2 = 0;
-        if (i & 1) {
-            term2 = n >> 1;
-        }
-        rev[i] = (rev[i >> 1] >> 1) | term2;
-        i = add(i, 1);
-        goto precompute_rev_loop;
+    if (IS_NOT_ZERO(map_input(path_b, &in_b))) {
+        fprintf(stderr, "Error: Cannot read %s\n", path_b);
+        goto unmap_a;
     }
 
-    ntt(ntt_a, n, 0);
-    ntt(ntt_b, n, 0);
-
-    i = 0;
-pointwise_mul_loop:
-    if (IS_LESS(i, n)) { ntt_a[i] = mod_mul(ntt_a[i], ntt_b[i]); i = add(i, 1); goto pointwise_mul_loop; }
-
-    ntt(ntt_a, n, 1);
-    
-    ll carry = 0;
-    i = 0;
-carry_loop:
-    if (IS_LESS(i, n)) {
-        ll current_val = add(ntt_a[i], carry);
-        ll q = 0, rem = 0, temp_val = current_val;
-        int bit = 63;
-    div_base_loop:
-        if(IS_GREATER_EQUAL(bit, 0)){
-            rem = rem << 1; rem = rem | ((temp_val >> bit) & 1);
-            q = q << 1;
-            if(IS_GREATER_EQUAL(rem, BASE)){ rem = subtract(rem, BASE); q = q | 1; }
-            bit = subtract(bit, 1);
-            goto div_base_loop;
+    size_t cap = bigmul_out_size(in_a.len, in_b.len);
+    if (path_out) {
+        if (IS_NOT_ZERO(map_output(path_out, cap, &out_file))) {
+            fprintf(stderr, "Error: Cannot write %s\n", path_out);
+            goto unmap_b;
         }
-        result[i] = rem; carry = q;
-        i = add(i, 1);
-        goto carry_loop;
+        out = out_file.data;
+    } else {
+        out = malloc(cap);
+    }
+
+    ctx = create_ctx();
+    if (ctx && out) {
+        status = bigmul(ctx, in_a.data, in_a.len, in_b.data, in_b.len, out, &out_len);
+    }
+    bigmul_destroy(ctx);
+
+    if (IS_EQUAL(status, BIGMUL_ERR_INPUT)) {
+        fprintf(stderr, "Error: Invalid input. Only positive integers are allowed.\n");
+    } else if (IS_NOT_ZERO(status)) {
+        fprintf(stderr, "Error: Multiplication failed (%d).\n", status);
+    } else {
+        exit_code = 0;
     }
 
-    int final_len = n;
-propagate_carry:
-    if (IS_NOT_ZERO(carry)) {
-        ll q = 0, rem = 0, temp_val = carry;
-        int bit = 63;
-    final_div_base_loop:
-        if (IS_GREATER_EQUAL(bit, 0)) {
-            rem = rem << 1; rem = rem | ((temp_val >> bit) & 1);
-            q = q << 1;
-            if (IS_GREATER_EQUAL(rem, BASE)) { rem = subtract(rem, BASE); q = q | 1; }
-            bit = subtract(bit, 1);
-            goto final_div_base_loop;
+    if (path_out) {
+        unmap_file(&out_file);
+        // Drops the worst-case padding past the product
+        if (IS_NOT_ZERO(truncate(path_out, out_len))) {
+            fprintf(stderr, "Error: Cannot truncate %s\n", path_out);
+            exit_code = 1;
         }
-        result[final_len] = rem; carry = q;
-        final_len = add(final_len, 1);
-        goto propagate_carry;
+    } else {
+        if (IS_EQUAL(exit_code, 0)) {
+            fputs("Result: ", stdout);
+            fwrite(out, 1, out_len, stdout);
+            putchar('\n');
+        }
+        free(out);
+    }
+unmap_b:
+    unmap_file(&in_b);
+unmap_a:
+    unmap_file(&in_a);
+    return exit_code;
+}
+
+// Batch mode
+// ======================================================================
+// ./multiply --batch [in_file [out_file]], stdin / stdout by default. Every record is
+//   <len_a> <len_b>\n<a>\n<b>\n
+// and every answer, in input order, is
+//   <len>\n<product>\n
+// or a single line with the status code (BIGMUL_ERR_*) when the pair is rejected.
+// The reader keeps up to BATCH_WINDOW records in flight, workers (one context each, so
+// twiddles and scratch live for the whole run) take them in order, and the writer
+// streams answers out as soon as the oldest one is done.
+typedef struct {
+    char* a;                      // a and b share one allocation
+    char* b;
+    size_t la, lb;
+    char* out;
+    size_t out_len;
+    int status;
+    int done;
+} batch_item;
+
+typedef struct {
+    FILE* in;
+    FILE* out;
+    batch_item items[BATCH_WINDOW];
+    size_t read_pos, claim_pos, write_pos;
+    int eof;
+    pthread_mutex_t lock;
+    pthread_cond_t changed;
+} batch_state;
+
+typedef struct {
+    batch_state* state;
+    bigmul_ctx* ctx;
+} batch_worker;
+
+static batch_item* slot(batch_state* st, size_t pos) { return &st->items[pos & subtract(BATCH_WINDOW, 1)]; }
+
+static void* batch_work(void* p) {
+    batch_worker* w = p;
+    batch_state* st = w->state;
+    pthread_mutex_lock(&st->lock);
+claim_loop:
+    if (IS_EQUAL(st->claim_pos, st->read_pos)) {
+        if (IS_NOT_ZERO(st->eof)) { pthread_mutex_unlock(&st->lock); return NULL; }
+        pthread_cond_wait(&st->changed, &st->lock);
+        goto claim_loop;
+    }
+    batch_item* item = slot(st, st->claim_pos);
+    st->claim_pos = -~st->claim_pos;
+    pthread_mutex_unlock(&st->lock);
+
+    item->out = malloc(bigmul_out_size(item->la, item->lb));
+    item->status = item->out ? bigmul(w->ctx, item->a, item->la, item->b, item->lb, item->out, &item->out_len) : BIGMUL_ERR_NOMEM;
+
+    pthread_mutex_lock(&st->lock);
+    item->done = 1;
+    pthread_cond_broadcast(&st->changed);
+    goto claim_loop;
+}
+
+static void* batch_write(void* p) {
+    batch_state* st = p;
+    pthread_mutex_lock(&st->lock);
+write_loop:
+    if (IS_EQUAL(st->write_pos, st->read_pos) && IS_NOT_ZERO(st->eof)) {
+        pthread_mutex_unlock(&st->lock);
+        fflush(st->out);
+        return NULL;
+    }
+    batch_item* item = slot(st, st->write_pos);
+    if (IS_EQUAL(st->write_pos, st->read_pos) || !item->done) {
+        // Nothing ready: push out what is buffered before sleeping
+        pthread_mutex_unlock(&st->lock);
+        fflush(st->out);
+        pthread_mutex_lock(&st->lock);
+        if (IS_EQUAL(st->write_pos, st->read_pos) ? !st->eof : !item->done) { pthread_cond_wait(&st->changed, &st->lock); }
+        goto write_loop;
+    }
+    pthread_mutex_unlock(&st->lock);
+
+    if (IS_NOT_ZERO(item->status)) {
+        fprintf(st->out, "%d\n", item->status);
+    } else {
+        fprintf(st->out, "%zu\n", item->out_len);
+        fwrite(item->out, 1, item->out_len, st->out);
+        putc('\n', st->out);
+    }
+    free(item->a);
+    free(item->out);
+
+    pthread_mutex_lock(&st->lock);
+    item->done = 0;
+    st->write_pos = -~st->write_pos;
+    pthread_cond_broadcast(&st->changed);
+    goto write_loop;
+}
+
+// Skips whitespace, then reads exactly len bytes
+static int read_operand(FILE* in, char* dst, size_t len) {
+    int c;
+skip_loop:
+    c = getc(in);
+    if (IS_SPACE(c)) { goto skip_loop; }
+    if (IS_EQUAL(c, EOF)) { return -1; }
+    dst[0] = c;
+    return IS_EQUAL(fread(&dst[1], 1, subtract(len, 1), in), subtract(len, 1)) ? 0 : -1;
+}
+
+// 1 on a record, 0 on a clean end of stream, -1 on a malformed one
+static int read_record(FILE* in, batch_item* item) {
+    size_t la, lb;
+    int fields = fscanf(in, "%zu %zu", &la, &lb);
+    if (IS_EQUAL(fields, EOF)) { return 0; }
+    if (!IS_EQUAL(fields, 2) || IS_EQUAL(la, 0) || IS_EQUAL(lb, 0)) { return -1; }
+
+    size_t total;
+    if (__builtin_add_overflow(la, lb, &total)) { return -1; }
+    item->a = malloc(total);
+    if (!item->a) { return -1; }
+    item->b = &item->a[la];
+    item->la = la;
+    item->lb = lb;
+    if (IS_NOT_ZERO(read_operand(in, item->a, la)) || IS_NOT_ZERO(read_operand(in, item->b, lb))) {
+        free(item->a);
+        return -1;
+    }
+    return 1;
+}
+
+int multiply_batch(const char* path_in, const char* path_out) {
+    static batch_state st;
+    int workers = thread_count(), started = 0, writing = 0, exit_code = 0, t;
+    pthread_t writer;
+    pthread_t* threads = calloc(workers, sizeof(pthread_t));
+    batch_worker* pool = calloc(workers, sizeof(batch_worker));
+
+    st.in = path_in ? fopen(path_in, "r") : stdin;
+    st.out = path_out ? fopen(path_out, "w") : stdout;
+    if (!st.in || !st.out || !threads || !pool) {
+        fprintf(stderr, "Error: Cannot open batch streams\n");
+        exit_code = 1;
+        goto release;
     }
+    pthread_mutex_init(&st.lock, NULL);
+    pthread_cond_init(&st.changed, NULL);
 
-final_len_check:
-    if (IS_GREATER(final_len, 1)) {
-        if (IS_EQUAL(result[subtract(final_len, 1)], 0)) {
-            final_len = subtract(final_len, 1);
-            goto final_len_check;
+    t = 0;
+spawn_loop:
+    if (IS_NOT_ZERO(subtract(t, workers))) {
+        pool[t].state = &st;
+        pool[t].ctx = bigmul_create(0);
+        set_verify(pool[t].ctx);
+        if (pool[t].ctx && IS_EQUAL(pthread_create(&threads[t], NULL, batch_work, &pool[t]), 0)) {
+            started = -~started;
+            t = -~t;
+            goto spawn_loop;
         }
+        bigmul_destroy(pool[t].ctx);
     }
-    
-    print_from_base(result, final_len);
+    if (IS_EQUAL(started, 0) || IS_NOT_ZERO(pthread_create(&writer, NULL, batch_write, &st))) {
+        fprintf(stderr, "Error: Cannot start batch workers\n");
+        exit_code = 1;
+        goto shutdown;
+    }
+    writing = 1;
+
+read_loop:
+    pthread_mutex_lock(&st.lock);
+    if (IS_EQUAL(subtract(st.read_pos, st.write_pos), BATCH_WINDOW)) {
+        pthread_cond_wait(&st.changed, &st.lock);
+        pthread_mutex_unlock(&st.lock);
+        goto read_loop;
+    }
+    pthread_mutex_unlock(&st.lock);
+
+    // The slot at read_pos belongs to the reader until read_pos moves past it
+    int got = read_record(st.in, slot(&st, st.read_pos));
+    if (IS_EQUAL(got, 1)) {
+        pthread_mutex_lock(&st.lock);
+        st.read_pos = -~st.read_pos;
+        pthread_cond_broadcast(&st.changed);
+        pthread_mutex_unlock(&st.lock);
+        goto read_loop;
+    }
+    if (IS_EQUAL(got, -1)) {
+        fprintf(stderr, "Error: Malformed record %zu\n", st.read_pos);
+        exit_code = 1;
+    }
+
+shutdown:
+    pthread_mutex_lock(&st.lock);
+    st.eof = 1;
+    pthread_cond_broadcast(&st.changed);
+    pthread_mutex_unlock(&st.lock);
+    // The writer drains everything read so far before it returns
+    if (IS_NOT_ZERO(writing)) { pthread_join(writer, NULL); }
+    t = 0;
+join_loop:
+    if (IS_NOT_ZERO(subtract(t, started))) {
+        pthread_join(threads[t], NULL);
+        bigmul_destroy(pool[t].ctx);
+        t = -~t;
+        goto join_loop;
+    }
+release:
+    free(threads);
+    free(pool);
+    if (path_in && st.in) { fclose(st.in); }
+    if (path_out && st.out) { fclose(st.out); }
+    return exit_code;
 }
 
-int main() {
+int main(int argc, char* argv[]) {
+    if ((IS_EQUAL(argc, 2) | IS_EQUAL(argc, 3) | IS_EQUAL(argc, 4)) && IS_EQUAL(strcmp(argv[1], "--batch"), 0)) {
+        return multiply_batch(IS_EQUAL(argc, 2) ? NULL : argv[2], IS_EQUAL(argc, 4) ? argv[3] : NULL);
+    }
+    if (IS_EQUAL(argc, 3) | IS_EQUAL(argc, 4)) {
+        return multiply_files(argv[1], argv[2], IS_EQUAL(argc, 4) ? argv[3] : NULL);
+    }
+    if (!IS_EQUAL(argc, 1)) {
+        fprintf(stderr, "Usage: %s [a_file b_file [result_file]]\n       %s --batch [in_file [out_file]]\n", argv[0], argv[0]);
+        return 1;
+    }
+
     // clock_t start_time = clock();
 
     multiply_convolution();
@@ -294,4 +461,4 @@ int main() {
     // printf("Time taken: %f seconds\n", time_taken);
 
     return 0;
-}
\ No newline at end of file
+}